@@ -1,5 +1,7 @@
 #!/usr/bin/env bash
 set -euo pipefail
+PG="${POLYGLOT_BIN:-${0%/*}/../../polyglot}"
+if [ -x "$PG" ]; then exec "$PG" "${1:-all}" "abcl"; fi
 IMG="hello-abcl"
 PLATFORM="${POLYGLOT_PLATFORM:-}"
 if [ -n "$PLATFORM" ]; then
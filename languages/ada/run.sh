@@ -1,5 +1,7 @@
 #!/usr/bin/env bash
 set -euo pipefail
+PG="${POLYGLOT_BIN:-${0%/*}/../../polyglot}"
+if [ -x "$PG" ]; then exec "$PG" "${1:-all}" "ada"; fi
 IMG="hello-ada"
 PLATFORM="${POLYGLOT_PLATFORM:-}"
 if [ -n "$PLATFORM" ]; then
@@ -6,6 +6,34 @@ LANG_DIR="$ROOT_DIR/languages"
 
 VERBOSE=0
 FILTERS=()
+RETRIES=0
+RETRY_BUDGET=""
+FLAKE_THRESHOLD=20
+FLAKE_WINDOW=20
+FLAKE_MIN_SWEEPS=3
+ORDER=alpha
+BASE_REV="HEAD"
+FAILED_WINDOW=5
+FAIL_FAST=0
+JOBS=1
+NUMA=0
+BACKEND=docker
+AFFECTED_REV=""
+SKIP_UNCHANGED=0
+ARCHIVE="${POLYGLOT_ARCHIVE:-}"
+BUILD_CACHE="${POLYGLOT_BUILD_CACHE:-}"
+CACHE_BUDGET_GB=10
+PROXY=0
+PROXY_OFFLINE=0
+PROXY_LISTEN=""
+PROXY_DIR="$ROOT_DIR/.polyglot/proxy"
+MERKLE_DIR="$ROOT_DIR/.polyglot/merkle"
+PASSED_DIR="$ROOT_DIR/.polyglot/passed"
+SCAFFOLD="${POLYGLOT_SCAFFOLD:-$ROOT_DIR/scaffold}"
+POLYGLOT="${POLYGLOT_BIN:-$ROOT_DIR/polyglot}"
+HISTORY="${POLYGLOT_HISTORY:-$ROOT_DIR/.polyglot/history.tsv}"
+LOG_DIR="$ROOT_DIR/.polyglot/logs"
+KEEP_LOGS=20
 
 # Parse flags (supports old bash; no getopt)
 while [ $# -gt 0 ]; do
@@ -14,6 +42,99 @@ while [ $# -gt 0 ]; do
       VERBOSE=1
       shift
       ;;
+    --retries)
+      RETRIES="$2"
+      shift 2
+      ;;
+    --retry-budget)
+      RETRY_BUDGET="$2"
+      shift 2
+      ;;
+    --flake-threshold)
+      FLAKE_THRESHOLD="$2"
+      shift 2
+      ;;
+    --history)
+      HISTORY="$2"
+      shift 2
+      ;;
+    --no-history)
+      HISTORY=""
+      shift
+      ;;
+    --no-logs)
+      LOG_DIR=""
+      shift
+      ;;
+    --keep-logs)
+      KEEP_LOGS="$2"
+      shift 2
+      ;;
+    --order)
+      ORDER="$2"
+      shift 2
+      ;;
+    --base)
+      BASE_REV="$2"
+      shift 2
+      ;;
+    --failed-window)
+      FAILED_WINDOW="$2"
+      shift 2
+      ;;
+    --fail-fast)
+      FAIL_FAST=1
+      shift
+      ;;
+    --affected)
+      AFFECTED_REV="$2"
+      shift 2
+      ;;
+    --skip-unchanged)
+      SKIP_UNCHANGED=1
+      shift
+      ;;
+    --archive)
+      ARCHIVE="$2"
+      shift 2
+      ;;
+    --build-cache)
+      BUILD_CACHE="$2"
+      shift 2
+      ;;
+    --cache-budget-gb)
+      CACHE_BUDGET_GB="$2"
+      shift 2
+      ;;
+    --proxy)
+      PROXY=1
+      shift
+      ;;
+    --proxy-offline)
+      PROXY=1
+      PROXY_OFFLINE=1
+      shift
+      ;;
+    --proxy-listen)
+      PROXY_LISTEN="$2"
+      shift 2
+      ;;
+    --profile)
+      export POLYGLOT_PROFILE="$2"
+      shift 2
+      ;;
+    -j|--jobs)
+      JOBS="$2"
+      shift 2
+      ;;
+    --numa)
+      NUMA=1
+      shift
+      ;;
+    --backend)
+      BACKEND="$2"
+      shift 2
+      ;;
     *)
       FILTERS+=("$1")
       shift
@@ -21,8 +142,31 @@ while [ $# -gt 0 ]; do
   esac
 done
 
+# --base REV: check it once here, so a typo fails loudly rather than ordering as if
+# nothing changed.
+if [ "$ORDER" = "changed-first" ] || [ "$BASE_REV" != "HEAD" ]; then
+  if ! git -C "$ROOT_DIR" rev-parse --quiet --verify "$BASE_REV^{commit}" > /dev/null; then
+    echo "Unknown --base revision: $BASE_REV" >&2
+    exit 2
+  fi
+fi
+
+# --affected REV: only slugs whose generated artifacts changed since REV
+# (manifest rows, fixups and templates), as computed by scaffold.
+AFFECTED=""
+if [ -n "$AFFECTED_REV" ]; then
+  AFFECTED=" $(cd "$ROOT_DIR" && "$SCAFFOLD" languages.tsv --affected "$AFFECTED_REV" | tr '\n' ' ') "
+  if [ "$AFFECTED" = "  " ]; then
+    echo "No languages affected since $AFFECTED_REV"
+    exit 0
+  fi
+fi
+
 matches_filter() {
   local name="$1"
+  if [ -n "$AFFECTED" ]; then
+    case "$AFFECTED" in *" $name "*) ;; *) return 1 ;; esac
+  fi
   if [ "${#FILTERS[@]}" -eq 0 ]; then return 0; fi
   local f
   for f in "${FILTERS[@]}"; do
@@ -47,17 +191,213 @@ fi
 passes=()
 fails=()
 skips=()
+flaky=()
+quarantined=()
+retries_used=0
+
+SWEEP_ID="$(date -u +%Y%m%dT%H%M%SZ)-$$"
+if [ -n "$HISTORY" ]; then mkdir -p "$(dirname "$HISTORY")"; fi
+
+# Wall clock with sub-second resolution where the shell provides it (bash 5+).
+now() {
+  if [ -n "${EPOCHREALTIME:-}" ]; then echo "$EPOCHREALTIME"; else date +%s; fi
+}
+
+# History store: one TSV row per phase attempt
+#   sweep_id  slug  attempt  phase(build|run)  exit  seconds  [node  cpu_s  peak_mb]
+# (the last three are written by parallel sweeps: the NUMA node, "-" when the job
+# wasn't pinned, and the container's CPU seconds and peak memory in MiB from its
+# cgroup, "-" when it wasn't visible; `polyglot resources` learns from them)
+record() {
+  [ -n "$HISTORY" ] || return 0
+  printf "%s\t%s\t%s\t%s\t%s\t%s\n" "$SWEEP_ID" "$@" >>"$HISTORY"
+}
+
+# Per-slug flake rate over the last FLAKE_WINDOW sweeps. A slug "flaked" in a
+# sweep if it failed at least once and then passed its run phase on a retry.
+# Prints "slug flaky total" for slugs at or above FLAKE_THRESHOLD percent.
+flaky_slugs() {
+  [ -n "$HISTORY" ] && [ -f "$HISTORY" ] || return 0
+  awk -F '\t' -v window="$FLAKE_WINDOW" -v thresh="$FLAKE_THRESHOLD" -v min="$FLAKE_MIN_SWEEPS" '
+    !($1 in seen) { seen[$1] = ++nsweeps; }
+    { k = $1 SUBSEP $2; keys[k] = 1; if ($5 != 0) failed[k] = 1; else if ($4 == "run") passed[k] = 1; }
+    END {
+      for (k in keys) {
+        split(k, p, SUBSEP);
+        if (seen[p[1]] <= nsweeps - window) continue;
+        total[p[2]]++;
+        if ((k in failed) && (k in passed)) flakes[p[2]]++;
+      }
+      for (s in total)
+        if (total[s] >= min && 100 * flakes[s] >= thresh * total[s])
+          printf "%s %d %d\n", s, flakes[s], total[s];
+    }' "$HISTORY"
+}
+
+# Space-delimited so membership tests work without associative arrays (bash 3).
+QUARANTINE_REPORT="$(flaky_slugs | sort)"
+QUARANTINE=" $(echo "$QUARANTINE_REPORT" | awk '{ print $1 }' | tr '\n' ' ') "
+is_quarantined() {
+  case "$QUARANTINE" in *" $1 "*) return 0 ;; esac
+  return 1
+}
 
 echo "== Polyglot Hello Runner =="
 
+# Merkle index written by scaffold: .polyglot/merkle/<slug> starts with the slug's
+# subtree hash, .polyglot/merkle/ROOT summarizes them all. .polyglot/passed mirrors
+# the hashes that last passed, so unchanged slugs can be skipped.
+merkle_hash() {
+  local h=""
+  [ -f "$1" ] && read -r h <"$1"
+  echo "$h"
+}
+
+slug_unchanged() {
+  local want
+  want="$(merkle_hash "$MERKLE_DIR/$1")"
+  [ -n "$want" ] && [ "$want" = "$(merkle_hash "$PASSED_DIR/$1")" ]
+}
+
+mark_passed() {
+  local h
+  h="$(merkle_hash "$MERKLE_DIR/$1")"
+  [ -n "$h" ] || return 0
+  mkdir -p "$PASSED_DIR"
+  echo "$h" >"$PASSED_DIR/$1"
+}
+
+if [ $SKIP_UNCHANGED -eq 1 ]; then
+  root_hash="$(merkle_hash "$MERKLE_DIR/ROOT")"
+  if [ -n "$root_hash" ] && [ "$root_hash" = "$(merkle_hash "$PASSED_DIR/ROOT")" ]; then
+    echo "Tree unchanged since last green sweep ($root_hash)"
+    exit 0
+  fi
+fi
+unchanged=0
+
+# --archive FILE: build contexts come straight out of a scaffold --output-archive
+# tar[.zst] via the polyglot dispatcher; languages/ need not exist.
+if [ -n "$ARCHIVE" ]; then
+  if [ ! -x "$POLYGLOT" ]; then
+    echo "--archive needs the polyglot dispatcher (build it, or set POLYGLOT_BIN)" >&2
+    exit 2
+  fi
+  case "$ARCHIVE" in /*) ;; *) ARCHIVE="$PWD/$ARCHIVE" ;; esac
+  export POLYGLOT_ARCHIVE="$ARCHIVE"
+fi
+
+# --profile: launch profiles are applied by the dispatcher only.
+if [ "${POLYGLOT_PROFILE:-default}" != "default" ] && [ ! -x "$POLYGLOT" ]; then
+  echo "--profile $POLYGLOT_PROFILE needs the polyglot dispatcher (build it, or set POLYGLOT_BIN)" >&2
+  exit 2
+fi
+
+# --build-cache DIR: builds import and export a local BuildKit cache per slug under
+# DIR (a plain directory; rsync or NFS it between workers). Pruned to
+# --cache-budget-gb after the sweep.
+if [ -n "$BUILD_CACHE" ]; then
+  if [ ! -x "$POLYGLOT" ]; then
+    echo "--build-cache needs the polyglot dispatcher (build it, or set POLYGLOT_BIN)" >&2
+    exit 2
+  fi
+  case "$BUILD_CACHE" in /*) ;; *) BUILD_CACHE="$PWD/$BUILD_CACHE" ;; esac
+  mkdir -p "$BUILD_CACHE"
+  export POLYGLOT_BUILD_CACHE="$BUILD_CACHE"
+fi
+
+# Every generated slug: from the archive, else the languages/ directories.
+all_slugs() {
+  if [ -n "$ARCHIVE" ]; then
+    POLYGLOT_ROOT="$ROOT_DIR" "$POLYGLOT" list | sort
+  else
+    for d in "$LANG_DIR"/*; do
+      [ -d "$d" ] && basename "$d"
+    done
+  fi
+}
+
 # Build list of languages first so we can show [i/N]
 langs=()
-for d in "$LANG_DIR"/*; do
-  [ -d "$d" ] || continue
-  lang="$(basename "$d")"
+while IFS= read -r lang; do
   matches_filter "$lang" || continue
+  if [ $SKIP_UNCHANGED -eq 1 ] && slug_unchanged "$lang"; then
+    unchanged=$((unchanged + 1))
+    continue
+  fi
   langs+=("$lang")
-done
+done < <(all_slugs)
+
+# Slugs whose manifest row differs between BASE_REV and the working tree.
+changed_slugs() {
+  git -C "$ROOT_DIR" diff --unified=0 "$BASE_REV" -- languages.tsv \
+    | awk -F '\t' '/^[+-]/ && !/^(\+\+\+|---)/ { print substr($1, 2) }' \
+    | sort -u
+}
+
+# changed-first: rows touched in the current diff, then slugs that failed in
+# the last FAILED_WINDOW sweeps, then everything else by ascending mean
+# duration from the history store (unknown durations last, alphabetical).
+order_changed_first() {
+  local l ordered=()
+  while IFS= read -r l; do ordered+=("$l"); done < <(
+    {
+      changed_slugs | awk '{ print "C\t" $0 }'
+      if [ -n "$HISTORY" ] && [ -f "$HISTORY" ]; then awk '{ print "H\t" $0 }' "$HISTORY"; fi
+      for l in "${langs[@]}"; do printf 'L\t%s\n' "$l"; done
+    } | awk -F '\t' -v window="$FAILED_WINDOW" '
+      $1 == "C" { changed[$2] = 1; next }
+      $1 == "H" {
+        if (!($2 in seen)) seen[$2] = ++nsweeps;
+        k = $2 SUBSEP $3; keys[k] = 1; secs[$3] += $7;
+        if ($5 == "run" && $6 == 0) passed[k] = 1;
+        next
+      }
+      $1 == "L" { order[++n] = $2 }
+      END {
+        for (k in keys) {
+          split(k, p, SUBSEP);
+          runs[p[2]]++;
+          if (seen[p[1]] > nsweeps - window && !(k in passed)) failed[p[2]] = 1;
+        }
+        for (i = 1; i <= n; i++) {
+          s = order[i];
+          tier = (s in changed) ? 0 : (s in failed) ? 1 : 2;
+          dur = (s in runs) ? secs[s] / runs[s] : 999999999;
+          printf "%d %.3f %d %s\n", tier, dur, i, s;
+        }
+      }' | sort -k1,1n -k2,2n -k3,3n | awk '{ print $4 }'
+  )
+  if [ "${#ordered[@]}" -gt 0 ]; then langs=("${ordered[@]}"); fi
+}
+
+# locality: images sharing a base and layers back to back, so their layers are
+# still in the page cache when the next container starts (polyglot order locality).
+order_locality() {
+  if [ ! -x "$POLYGLOT" ]; then
+    echo "--order locality needs the polyglot dispatcher (build it, or set POLYGLOT_BIN)" >&2
+    exit 2
+  fi
+  local l ordered=()
+  while IFS= read -r l; do ordered+=("$l"); done < <(
+    POLYGLOT_ROOT="$ROOT_DIR" "$POLYGLOT" order locality "${langs[@]}"
+  )
+  if [ "${#ordered[@]}" -gt 0 ]; then langs=("${ordered[@]}"); fi
+}
+
+case "$ORDER" in
+  alpha) ;;
+  changed-first) if [ "${#langs[@]}" -gt 0 ]; then order_changed_first; fi ;;
+  locality) if [ "${#langs[@]}" -gt 0 ]; then order_locality; fi ;;
+  *) echo "Unknown --order: $ORDER (expected alpha, changed-first or locality)" >&2; exit 2 ;;
+esac
+
+# KiB read from block devices so far (Linux /proc/vmstat pgpgin), "" elsewhere.
+# The delta over the sweep is the cold-read I/O that ordering tries to cut.
+disk_read_kib() {
+  awk '$1 == "pgpgin" { print $2 }' /proc/vmstat 2>/dev/null || true
+}
+DISK_READ_START="$(disk_read_kib)"
 
 N="${#langs[@]}"
 i=0
@@ -80,14 +420,206 @@ last_clean_line() {
     | tail -n 1
 }
 
+# Invokes one phase for a language: straight through the polyglot dispatcher when
+# it's built (no subshell, cd or bash), else the plain docker command run.sh would
+# fall back to for that phase.
+invoke_phase() {
+  if [ -x "$POLYGLOT" ]; then
+    POLYGLOT_ROOT="$ROOT_DIR" "$POLYGLOT" "$2" "$1"
+    return
+  fi
+  local plat=()
+  if [ -n "${POLYGLOT_PLATFORM:-}" ]; then plat=(--platform "$POLYGLOT_PLATFORM"); fi
+  case "$2" in
+    build) docker build ${plat[@]+"${plat[@]}"} -t "hello-$1" "$LANG_DIR/$1" ;;
+    run) docker run --rm ${plat[@]+"${plat[@]}"} "hello-$1" ;;
+  esac
+}
+
+# run_phase <lang> <phase> <attempt> [out_file err_file]
+# Runs one phase of a language and records it in the history store. In -v mode the
+# output scrolls past and, given files, is also copied into them for the log archive.
+run_phase() {
+  local lang="$1" phase="$2" attempt="$3"
+  local start status=0
+  start="$(now)"
+  if [ $VERBOSE -eq 0 ]; then
+    invoke_phase "$lang" "$phase" >"$4" 2>"$5" || status=$?
+  elif [ -n "${4:-}" ]; then
+    # stderr through one tee back to stderr, stdout through the other; pipefail keeps
+    # the phase's own exit status.
+    { invoke_phase "$lang" "$phase" 2>&1 1>&3 3>&- | tee "$5" >&2; } 3>&1 | tee "$4" || status=$?
+  else
+    invoke_phase "$lang" "$phase" || status=$?
+  fi
+  record "$lang" "$attempt" "$phase" "$status" \
+    "$(awk -v a="$start" -v b="$(now)" 'BEGIN { printf "%.3f", b - a }')"
+  if [ -n "${4:-}" ] && [ -n "$LOG_DIR" ] && [ -x "$POLYGLOT" ]; then
+    POLYGLOT_ROOT="$ROOT_DIR" "$POLYGLOT" logs add "$SWEEP_ID" "$lang" "$phase" "$attempt" "$status" "$4" "$5" || true
+  fi
+  return $status
+}
+
+# True while another rerun is allowed for the current job.
+may_retry() {
+  [ "$1" -le "$RETRIES" ] || return 1
+  [ -z "$RETRY_BUDGET" ] || [ "$retries_used" -lt "$RETRY_BUDGET" ] || return 1
+  return 0
+}
+
+# --proxy: package downloads of every build go through one `polyglot proxy`, which
+# keeps .deb/.apk files and indices under $PROXY_DIR and serves repeats from disk.
+# --proxy-offline serves only what it already has. Its counters for this sweep are
+# printed in the summary (and kept in $PROXY_DIR/stats.tsv). It listens on the
+# default bridge's gateway, which build containers reach without host networking;
+# without one it falls back to loopback, which builds only reach with --network host.
+PROXY_PID=""
+PROXY_OUT=""
+PROXY_STATS=""
+stop_proxy() {
+  [ -n "$PROXY_PID" ] || return 0
+  kill -TERM "$PROXY_PID" 2>/dev/null || true
+  wait "$PROXY_PID" 2>/dev/null || true
+  PROXY_PID=""
+  PROXY_STATS="$(awk -F '\t' '$1 == "#proxy" { print $2 }' "$PROXY_OUT")"
+  rm -f "$PROXY_OUT"
+}
+if [ $PROXY -eq 1 ] && [ "$BACKEND" = docker ]; then
+  if [ ! -x "$POLYGLOT" ]; then
+    echo "--proxy needs the polyglot dispatcher (build it, or set POLYGLOT_BIN)" >&2
+    exit 2
+  fi
+  if [ -z "$PROXY_LISTEN" ]; then
+    gw="$(docker network inspect bridge --format '{{range .IPAM.Config}}{{.Gateway}}{{end}}' 2>/dev/null || true)"
+    PROXY_LISTEN="${gw:-127.0.0.1}:3142"
+  fi
+  case "$PROXY_LISTEN" in
+    127.*|localhost:*|\[::1\]:*)
+      if [ -n "$BUILD_CACHE" ]; then
+        echo "--proxy on loopback ($PROXY_LISTEN) needs host networking for builds, which the" >&2
+        echo "docker-container builder --build-cache uses doesn't allow; pass --proxy-listen with" >&2
+        echo "an address build containers reach (e.g. the bridge gateway, 172.17.0.1:3142)" >&2
+        exit 2
+      fi
+      ;;
+  esac
+  PROXY_OUT="$(mktemp_file)"
+  proxy_args=(--listen "$PROXY_LISTEN" --dir "$PROXY_DIR" --sweep-id "$SWEEP_ID")
+  if [ $PROXY_OFFLINE -eq 1 ]; then proxy_args+=(--offline); fi
+  POLYGLOT_ROOT="$ROOT_DIR" "$POLYGLOT" proxy "${proxy_args[@]}" >"$PROXY_OUT" 2>&1 &
+  PROXY_PID=$!
+  trap stop_proxy EXIT
+  tries=0
+  while ! grep -q '^listening' "$PROXY_OUT" 2>/dev/null; do
+    tries=$((tries + 1))
+    if [ $tries -gt 50 ] || ! kill -0 "$PROXY_PID" 2>/dev/null; then
+      echo "polyglot proxy did not start:" >&2
+      cat "$PROXY_OUT" >&2
+      exit 2
+    fi
+    sleep 0.1
+  done
+  export POLYGLOT_PROXY="http://$(awk '/^listening/ { print $2; exit }' "$PROXY_OUT")"
+fi
+
+# --jobs N / --numa / --backend: hand the job loop to `polyglot sweep`, which runs N
+# jobs at a time (pinned to NUMA nodes with --numa) and prints one result line per
+# job as it finishes; reporting and the summary stay here. --backend sim replays the
+# history store instead of running Docker and leaves history and pass marks alone.
+# --archive goes through it too (at --jobs 1 that's still serial), so the archive is
+# decompressed once per sweep instead of by every `polyglot build` and `run`.
+PARALLEL=0
+OVERHEAD=""
+if [ "$JOBS" -gt 1 ] || [ $NUMA -eq 1 ] || [ "$BACKEND" != docker ] || [ -n "$ARCHIVE" ]; then PARALLEL=1; fi
+
+run_parallel() {
+  if [ ! -x "$POLYGLOT" ]; then
+    echo "--jobs/--numa/--backend need the polyglot dispatcher (build it, or set POLYGLOT_BIN)" >&2
+    exit 2
+  fi
+  local todo=() lang status phase attempts node line args
+  for lang in ${langs[@]+"${langs[@]}"}; do
+    if [ -z "$ARCHIVE" ] && [ ! -x "$LANG_DIR/$lang/run.sh" ]; then
+      i=$((i + 1))
+      printf "%s[%d/%d]%s %s%s%s: %sSKIP%s\n" \
+        "$C_COUNT" "$i" "$N" "$C_RESET" \
+        "$C_LANG" "$lang" "$C_RESET" \
+        "$C_SKIP" "$C_RESET"
+      skips+=("$lang")
+    else
+      todo+=("$lang")
+    fi
+  done
+  [ "${#todo[@]}" -gt 0 ] || return 0
+
+  args=(--jobs "$JOBS" --retries "$RETRIES" --sweep-id "$SWEEP_ID" --backend "$BACKEND")
+  if [ -n "$RETRY_BUDGET" ]; then args+=(--retry-budget "$RETRY_BUDGET"); fi
+  if [ -n "$HISTORY" ]; then args+=(--history "$HISTORY"); fi
+  if [ -n "$LOG_DIR" ]; then args+=(--log-dir "$LOG_DIR"); fi
+  if [ $FAIL_FAST -eq 1 ]; then args+=(--fail-fast); fi
+  # Quarantined slugs don't stop --fail-fast, as in the serial loop.
+  if [ -n "$QUARANTINE_REPORT" ]; then
+    args+=(--non-blocking "$(echo "$QUARANTINE_REPORT" | awk '{ print $1 }' | paste -sd, -)")
+  fi
+  if [ $NUMA -eq 1 ]; then args+=(--numa); fi
+  if [ $VERBOSE -eq 1 ]; then args+=(--verbose); fi
+
+  while IFS=$'\t' read -r lang status phase attempts node line; do
+    if [ "$lang" = "#overhead" ]; then
+      OVERHEAD="$status"
+      continue
+    fi
+    i=$((i + 1))
+    note=""
+    if [ "$node" != "-" ]; then note=" [node $node]"; fi
+    retries_used=$((retries_used + attempts - 1))
+    if [ "$status" -eq 0 ] && [ "$attempts" -gt 1 ]; then
+      flaky+=("$lang")
+      note="$note (passed on attempt $attempts)"
+    fi
+    if [ "$line" = "-" ]; then line=""; fi
+    if [ "$status" -eq 0 ]; then
+      printf "%s[%d/%d]%s %s%s%s: %s%s%s%s\n" \
+        "$C_COUNT" "$i" "$N" "$C_RESET" \
+        "$C_LANG" "$lang" "$C_RESET" \
+        "$C_OUT" "$line" "$C_RESET" "$note"
+      passes+=("$lang")
+      if [ "$BACKEND" = docker ]; then mark_passed "$lang"; fi
+      continue
+    fi
+    if is_quarantined "$lang"; then
+      label="${C_SKIP}FAIL${C_RESET} (quarantined)"
+      quarantined+=("$lang")
+    else
+      label="${C_FAIL}FAIL${C_RESET}"
+      fails+=("$lang")
+    fi
+    printf "%s[%d/%d]%s %s%s%s: %s (exit=%d, %s)%s %s\n" \
+      "$C_COUNT" "$i" "$N" "$C_RESET" \
+      "$C_LANG" "$lang" "$C_RESET" \
+      "$label" "$status" "$phase" "$note" "$line"
+  done < <(POLYGLOT_ROOT="$ROOT_DIR" "$POLYGLOT" sweep "${args[@]}" "${todo[@]}")
+
+  if [ $FAIL_FAST -eq 1 ] && [ $i -lt $N ]; then
+    echo "${C_FAIL}Stopping after first failure (--fail-fast); $((N - i)) not run${C_RESET}"
+  fi
+}
+
+if [ $PARALLEL -eq 1 ]; then run_parallel; fi
+
 idx=0
-while [ $idx -lt $N ]; do
+while [ $PARALLEL -eq 0 ] && [ $idx -lt $N ]; do
+  if [ $FAIL_FAST -eq 1 ] && [ "${#fails[@]}" -gt 0 ]; then
+    echo "${C_FAIL}Stopping after first failure (--fail-fast); $((N - idx)) not run${C_RESET}"
+    break
+  fi
+
   lang="${langs[$idx]}"
   d="$LANG_DIR/$lang"
   run="$d/run.sh"
   i=$((i + 1))
 
-  if [ ! -x "$run" ]; then
+  if [ -z "$ARCHIVE" ] && [ ! -x "$run" ]; then
     if [ $VERBOSE -eq 1 ]; then
       echo
       echo "---- $lang ----"
@@ -106,32 +638,63 @@ while [ $idx -lt $N ]; do
   if [ $VERBOSE -eq 1 ]; then
     echo
     echo "---- $lang ----"
-    set +e
-    (cd "$d" && ./run.sh)
-    status=$?
-    set -e
+  fi
+
+  # Pretty mode: capture stdout separately from stderr, per phase. -v mode keeps a
+  # copy too when there is a log archive to put it in.
+  build_out=""; build_err=""; out_file=""; err_file=""
+  if [ $VERBOSE -eq 0 ] || { [ -n "$LOG_DIR" ] && [ -x "$POLYGLOT" ]; }; then
+    build_out="$(mktemp_file)"; build_err="$(mktemp_file)"
+    out_file="$(mktemp_file)"; err_file="$(mktemp_file)"
+  fi
 
+  # Build once; if only the run phase fails, retries reuse the built image.
+  attempt=0
+  built=0
+  while :; do
+    attempt=$((attempt + 1))
+    status=0
+    failed_phase=""
+    if [ $built -eq 0 ]; then
+      run_phase "$lang" build "$attempt" "$build_out" "$build_err" || status=$?
+      if [ $status -eq 0 ]; then built=1; else failed_phase=build; fi
+    fi
+    if [ $built -eq 1 ]; then
+      run_phase "$lang" run "$attempt" "$out_file" "$err_file" || status=$?
+      if [ $status -ne 0 ]; then failed_phase=run; fi
+    fi
+
+    if [ $status -eq 0 ] || ! may_retry "$attempt"; then break; fi
+    retries_used=$((retries_used + 1))
+    if [ $VERBOSE -eq 1 ]; then
+      echo "${C_SKIP}RETRY${C_RESET} $lang ($failed_phase failed, exit=$status)"
+    fi
+  done
+
+  note=""
+  if [ $status -eq 0 ] && [ $attempt -gt 1 ]; then
+    flaky+=("$lang")
+    note=" (passed on attempt $attempt)"
+  fi
+
+  if [ $VERBOSE -eq 1 ]; then
     if [ $status -eq 0 ]; then
-      echo "${C_PASS}PASS${C_RESET}  $lang"
+      echo "${C_PASS}PASS${C_RESET}  $lang$note"
       passes+=("$lang")
+      mark_passed "$lang"
+    elif is_quarantined "$lang"; then
+      echo "${C_SKIP}FAIL${C_RESET}  $lang (exit=$status, $failed_phase, quarantined)"
+      quarantined+=("$lang")
     else
-      echo "${C_FAIL}FAIL${C_RESET}  $lang (exit=$status)"
+      echo "${C_FAIL}FAIL${C_RESET}  $lang (exit=$status, $failed_phase)"
       fails+=("$lang")
     fi
 
+    if [ -n "$out_file" ]; then rm -f "$build_out" "$build_err" "$out_file" "$err_file"; fi
     idx=$((idx + 1))
     continue
   fi
 
-  # Pretty mode: capture stdout separately from stderr.
-  out_file="$(mktemp_file)"
-  err_file="$(mktemp_file)"
-
-  set +e
-  (cd "$d" && ./run.sh) >"$out_file" 2>"$err_file"
-  status=$?
-  set -e
-
   if [ $status -eq 0 ]; then
     # Durable: prefer stdout only (avoids Nim/Guile/clang/docker warnings, etc.)
     hello="$(last_clean_line "$out_file")"
@@ -139,30 +702,106 @@ while [ $idx -lt $N ]; do
       # Fallback: if stdout is empty for some reason, try stderr as last resort.
       hello="$(last_clean_line "$err_file")"
     fi
-    printf "%s[%d/%d]%s %s%s%s: %s%s%s\n" \
+    printf "%s[%d/%d]%s %s%s%s: %s%s%s%s\n" \
       "$C_COUNT" "$i" "$N" "$C_RESET" \
       "$C_LANG" "$lang" "$C_RESET" \
-      "$C_OUT" "${hello:-}" "$C_RESET"
+      "$C_OUT" "${hello:-}" "$C_RESET" "$note"
     passes+=("$lang")
+    mark_passed "$lang"
   else
-    # On failure: show a short hint line, but don’t spam.
-    hint="$(last_clean_line "$err_file")"
-    if [ -z "${hint:-}" ]; then hint="$(last_clean_line "$out_file")"; fi
-    printf "%s[%d/%d]%s %s%s%s: %sFAIL%s (exit=%d) %s\n" \
+    # On failure: show a short hint line from the failing phase, but don’t spam.
+    if [ "$failed_phase" = build ]; then
+      hint="$(last_clean_line "$build_err")"
+      if [ -z "${hint:-}" ]; then hint="$(last_clean_line "$build_out")"; fi
+    else
+      hint="$(last_clean_line "$err_file")"
+      if [ -z "${hint:-}" ]; then hint="$(last_clean_line "$out_file")"; fi
+    fi
+    if is_quarantined "$lang"; then
+      label="${C_SKIP}FAIL${C_RESET} (quarantined)"
+      quarantined+=("$lang")
+    else
+      label="${C_FAIL}FAIL${C_RESET}"
+      fails+=("$lang")
+    fi
+    printf "%s[%d/%d]%s %s%s%s: %s (exit=%d) %s\n" \
       "$C_COUNT" "$i" "$N" "$C_RESET" \
       "$C_LANG" "$lang" "$C_RESET" \
-      "$C_FAIL" "$C_RESET" "$status" "${hint:-}"
-    fails+=("$lang")
+      "$label" "$status" "${hint:-}"
   fi
 
-  rm -f "$out_file" "$err_file"
+  rm -f "$build_out" "$build_err" "$out_file" "$err_file"
   idx=$((idx + 1))
 done
+stop_proxy
 
 echo
 echo "== Summary =="
 echo "PASS: ${#passes[@]}  ${passes[*]:-}"
 echo "FAIL: ${#fails[@]}  ${fails[*]:-}"
 echo "SKIP: ${#skips[@]}  ${skips[*]:-}"
+if [ $unchanged -gt 0 ]; then
+  echo "UNCHANGED: $unchanged (skipped; same tree hash as their last pass)"
+fi
+if [ "${#flaky[@]}" -gt 0 ]; then
+  echo "FLAKY: ${#flaky[@]}  ${flaky[*]:-} (retries used: $retries_used)"
+fi
+if [ -n "$OVERHEAD" ]; then
+  echo "OVERHEAD: $OVERHEAD (runner only, excluding containers)"
+fi
+if [ -n "$PROXY_STATS" ]; then
+  echo "Proxy: $PROXY_STATS"
+fi
+DISK_READ_END="$(disk_read_kib)"
+if [ -n "$DISK_READ_START" ] && [ -n "$DISK_READ_END" ]; then
+  echo "Disk reads: $((DISK_READ_END - DISK_READ_START)) KiB (order: $ORDER)"
+fi
+
+# Quarantined slugs never fail the sweep; they are reported separately.
+if [ -n "$QUARANTINE_REPORT" ]; then
+  echo
+  echo "== Quarantine (non-blocking, flake rate >= ${FLAKE_THRESHOLD}%) =="
+  echo "$QUARANTINE_REPORT" | while read -r slug flakes total; do
+    result="not run"
+    for q in ${passes[*]:-}; do [ "$q" = "$slug" ] && result="PASS"; done
+    for q in ${quarantined[*]:-}; do [ "$q" = "$slug" ] && result="FAIL"; done
+    echo "$slug  flaked in $flakes/$total sweeps  $result"
+  done
+fi
+
+# Full build/run output of every job is in $LOG_DIR/<sweep>.zst (`polyglot logs <slug>`);
+# keep the newest KEEP_LOGS sweeps.
+if [ -n "$LOG_DIR" ] && [ -f "$LOG_DIR/$SWEEP_ID.idx" ]; then
+  echo "Logs: polyglot logs <slug> --sweep $SWEEP_ID"
+  ls -1 "$LOG_DIR" | sed -n 's/\.idx$//p' | sort -r | tail -n +$((KEEP_LOGS + 1)) | while read -r old; do
+    rm -f "$LOG_DIR/$old.idx" "$LOG_DIR/$old.zst"
+  done
+fi
+
+# How much of this sweep's building the cache saved (cacheable steps that were hits,
+# read back from the logs), then bound the cache directory. A failed prune fails the run.
+PRUNE_OK=1
+if [ -n "$BUILD_CACHE" ] && [ "$BACKEND" = docker ]; then
+  if [ -n "$LOG_DIR" ] && [ -f "$LOG_DIR/$SWEEP_ID.idx" ]; then
+    echo "Build cache: $(POLYGLOT_ROOT="$ROOT_DIR" "$POLYGLOT" build-cache report --sweep "$SWEEP_ID" | cut -f2-)"
+  fi
+  if pruned="$(POLYGLOT_ROOT="$ROOT_DIR" "$POLYGLOT" build-cache prune --dir "$BUILD_CACHE" --max-gb "$CACHE_BUDGET_GB")"; then
+    echo "Build cache size: $(printf '%s\n' "$pruned" | head -1)"
+  else
+    echo "Build cache size: prune failed, $BUILD_CACHE may exceed ${CACHE_BUDGET_GB} GiB" >&2
+    PRUNE_OK=0
+  fi
+fi
+
+# Every slug in the index has passed at its current hash: the whole tree is green.
+if [ "${#fails[@]}" -eq 0 ] && [ -f "$MERKLE_DIR/ROOT" ]; then
+  green=1
+  for f in "$MERKLE_DIR"/*; do
+    slug="$(basename "$f")"
+    [ "$slug" = ROOT ] && continue
+    if ! slug_unchanged "$slug"; then green=0; break; fi
+  done
+  if [ $green -eq 1 ]; then cp "$MERKLE_DIR/ROOT" "$PASSED_DIR/ROOT"; fi
+fi
 
-[ "${#fails[@]}" -eq 0 ]
+[ "${#fails[@]}" -eq 0 ] && [ $PRUNE_OK -eq 1 ]
@@ -0,0 +1,133 @@
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../libpolyglot/polyglot.hpp"
+
+namespace fs = std::filesystem;
+
+// file_ref: corpus check and timing for find_last_file_ref.
+//
+// Runs the lexer-based find_last_file_ref and the original split-and-copy version
+// over the build/run command of every manifest row and fails if they disagree on
+// any of them. Then times both on that corpus and on the large heredoc-style
+// install commands, where the old version's per-token allocations dominate.
+//
+//   c++ -std=c++17 -O2 -o file_ref_bench tools/bench/file_ref.cpp tools/libpolyglot/*.cpp
+//   ./file_ref_bench [languages.tsv] [--iterations N]
+
+namespace legacy {
+
+// The tokenizer find_last_file_ref used before ShellLexer, kept verbatim as the reference.
+static std::vector<std::string> shellish_split(const std::string& s) {
+  std::vector<std::string> out;
+  std::string cur;
+  bool in_single = false, in_double = false;
+  for (char c : s) {
+    if (c == '\'' && !in_double) { in_single = !in_single; continue; }
+    if (c == '"'  && !in_single) { in_double = !in_double; continue; }
+
+    if (!in_single && !in_double && std::isspace((unsigned char)c)) {
+      if (!cur.empty()) { out.push_back(cur); cur.clear(); }
+      continue;
+    }
+    cur.push_back(c);
+  }
+  if (!cur.empty()) out.push_back(cur);
+  return out;
+}
+
+static std::string normalize_filename(const std::string& tok) {
+  fs::path p(tok);
+  auto leaf = p.filename().string();
+  if (leaf.rfind("./", 0) == 0) leaf = leaf.substr(2);
+  return leaf;
+}
+
+static std::string find_last_file_ref(const std::string& cmd, const std::string& ext) {
+  if (cmd.empty() || ext.empty()) return "";
+  std::string last;
+  for (auto tok : shellish_split(cmd)) {
+    tok = polyglot::strip_trailing_punct(tok);
+    tok = normalize_filename(tok);
+    if (polyglot::ends_with(tok, ext)) last = tok;
+  }
+  return last;
+}
+
+}  // namespace legacy
+
+struct Case {
+  std::string label;
+  std::string cmd;
+  std::string ext;
+};
+
+template <typename F>
+static double ns_per_call(const std::vector<Case>& cases, int iterations, F&& fn) {
+  size_t sink = 0;
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    for (const auto& c : cases) sink += fn(c.cmd, c.ext).size();
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  if (sink == 1) std::cerr << "";  // keep the calls observable
+  const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+  return ns / ((double)iterations * (double)cases.size());
+}
+
+static void report(const std::string& name, const std::vector<Case>& cases, int iterations) {
+  if (cases.empty()) return;
+  const double before = ns_per_call(cases, iterations, legacy::find_last_file_ref);
+  const double after = ns_per_call(cases, iterations, polyglot::find_last_file_ref);
+  std::cout << name << " (" << cases.size() << " commands): legacy " << (long)before << " ns/call, lexer "
+            << (long)after << " ns/call, " << before / after << "x\n";
+}
+
+int main(int argc, char** argv) {
+  try {
+    fs::path manifest = "languages.tsv";
+    int iterations = 2000;
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      if (arg == "--iterations" && i + 1 < argc) iterations = std::max(1, std::atoi(argv[++i]));
+      else manifest = arg;
+    }
+
+    const auto m = polyglot::Manifest::load(manifest);
+    std::vector<Case> corpus, large;
+    for (const auto& spec : m.rows()) {
+      const std::string ext = polyglot::file_ext(polyglot::normalize_filename(spec.file));
+      corpus.push_back({spec.slug + " build_cmd", spec.build_cmd, ext});
+      corpus.push_back({spec.slug + " run_cmd", spec.run_cmd, ext});
+      if (spec.install_cmd.size() >= 1024) large.push_back({spec.slug + " install_cmd", spec.install_cmd, ext});
+    }
+
+    // Corpus check: every current row must resolve exactly as before.
+    size_t mismatches = 0;
+    for (const auto& c : corpus) {
+      const auto want = legacy::find_last_file_ref(c.cmd, c.ext);
+      const auto got = polyglot::find_last_file_ref(c.cmd, c.ext);
+      if (want != got) {
+        std::cout << "MISMATCH " << c.label << ": legacy '" << want << "', lexer '" << got << "'\n";
+        ++mismatches;
+      }
+    }
+    if (mismatches) {
+      std::cout << mismatches << " of " << corpus.size() << " commands resolve differently\n";
+      return 1;
+    }
+    std::cout << "Corpus check: " << corpus.size() << " commands from " << m.rows().size()
+              << " rows resolve identically\n";
+
+    report("manifest build/run commands", corpus, iterations);
+    report("install commands >= 1 KiB", large, std::max(1, iterations / 10));
+    return 0;
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n";
+    return 1;
+  }
+}
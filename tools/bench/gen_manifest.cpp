@@ -0,0 +1,36 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "../libpolyglot/tree.hpp"
+#include "synthetic.hpp"
+
+// gen_manifest: write an n-row synthetic manifest sampled from a real one to stdout.
+//
+//   c++ -std=c++17 -O2 -o gen_manifest tools/bench/gen_manifest.cpp tools/libpolyglot/*.cpp
+//   ./gen_manifest 10000 > big.tsv              # from ./languages.tsv
+//   ./gen_manifest 10000 languages.tsv --seed 7
+
+int main(int argc, char** argv) {
+  try {
+    if (argc < 2) {
+      std::cerr << "Usage: gen_manifest <rows> [seed-manifest] [--seed N]\n";
+      return 2;
+    }
+    const size_t rows = std::strtoull(argv[1], nullptr, 10);
+    std::string source = "languages.tsv";
+    uint64_t seed = 1;
+    for (int i = 2; i < argc; ++i) {
+      const std::string arg = argv[i];
+      if (arg == "--seed" && i + 1 < argc) seed = std::strtoull(argv[++i], nullptr, 10);
+      else source = arg;
+    }
+    const std::string text = polyglot::read_file_or_empty(source);
+    if (text.empty()) throw std::runtime_error("Cannot read manifest: " + source);
+    std::cout << bench::synthetic_manifest(text, rows, seed);
+    return 0;
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n";
+    return 1;
+  }
+}
@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../libpolyglot/polyglot.hpp"
+
+// micro: Google Benchmark suite for libpolyglot's string helpers.
+//
+// Each function runs on two kinds of input. "manifest" cases use the fields of
+// languages.tsv as the parser and renderer actually see them (raw TSV lines, escaped
+// fields, unescaped commands); the largest install_cmd is also timed on its own.
+// "worst" cases are synthetic 64 KiB inputs aimed at each function's slow path.
+//
+//   c++ -std=c++17 -O2 -o micro_bench tools/bench/micro.cpp tools/libpolyglot/*.cpp -lbenchmark -lpthread
+//   ./micro_bench --benchmark_out=bench.json --benchmark_out_format=json
+//
+// POLYGLOT_BENCH_MANIFEST overrides the manifest path (default: languages.tsv).
+// Compare two runs with Google Benchmark's tools/compare.py benchmarks a.json b.json.
+
+namespace {
+
+using polyglot::LangSpec;
+
+constexpr size_t kWorstSize = 64 * 1024;
+
+struct Corpus {
+  std::vector<std::string> lines;        // raw TSV rows, header included
+  std::vector<std::string> raw_fields;   // every field as written (escaped, untrimmed)
+  std::vector<std::string> commands;     // unescaped install/build/run commands
+  std::string largest;                   // the largest unescaped install_cmd
+  std::string largest_raw;               // ...and as written in the TSV
+};
+
+const Corpus& corpus() {
+  static const Corpus c = [] {
+    const char* env = std::getenv("POLYGLOT_BENCH_MANIFEST");
+    const std::string path = env && *env ? env : "languages.tsv";
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+      std::fprintf(stderr, "Cannot open manifest: %s (set POLYGLOT_BENCH_MANIFEST)\n", path.c_str());
+      std::exit(2);
+    }
+    Corpus c;
+    for (std::string line; std::getline(in, line);) {
+      if (line.empty()) continue;
+      c.lines.push_back(line);
+      for (auto& f : polyglot::split_tabs(line)) {
+        if (f.size() > c.largest_raw.size()) c.largest_raw = f;
+        c.raw_fields.push_back(std::move(f));
+      }
+    }
+    std::ostringstream text;
+    for (const auto& l : c.lines) text << l << "\n";
+    const auto m = polyglot::Manifest::parse(text.str());
+    for (const LangSpec& s : m.rows()) {
+      for (const auto* cmd : {&s.install_cmd, &s.build_cmd, &s.run_cmd}) {
+        if (!cmd->empty()) c.commands.push_back(*cmd);
+      }
+      if (s.install_cmd.size() > c.largest.size()) c.largest = s.install_cmd;
+    }
+    return c;
+  }();
+  return c;
+}
+
+size_t total_bytes(const std::vector<std::string>& v) {
+  size_t n = 0;
+  for (const auto& s : v) n += s.size();
+  return n;
+}
+
+// Runs fn over every input once per iteration and reports bytes/items per second.
+template <typename F>
+void over(benchmark::State& state, const std::vector<std::string>& inputs, F fn) {
+  for (auto _ : state) {
+    for (const auto& s : inputs) fn(s);
+  }
+  state.SetItemsProcessed((int64_t)(state.iterations() * inputs.size()));
+  state.SetBytesProcessed((int64_t)(state.iterations() * total_bytes(inputs)));
+}
+
+template <typename F>
+void once(benchmark::State& state, const std::string& input, F fn) {
+  over(state, std::vector<std::string>{input}, fn);
+}
+
+std::string repeat(const std::string& unit, size_t size) {
+  std::string out;
+  out.reserve(size + unit.size());
+  while (out.size() < size) out += unit;
+  return out;
+}
+
+// ---- split_tabs ----
+
+void BM_split_tabs_manifest(benchmark::State& state) {
+  over(state, corpus().lines, [](const std::string& s) { benchmark::DoNotOptimize(polyglot::split_tabs(s)); });
+}
+void BM_split_tabs_worst_all_tabs(benchmark::State& state) {
+  once(state, std::string(kWorstSize, '\t'), [](const std::string& s) { benchmark::DoNotOptimize(polyglot::split_tabs(s)); });
+}
+void BM_split_tabs_worst_no_tabs(benchmark::State& state) {
+  once(state, std::string(kWorstSize, 'x'), [](const std::string& s) { benchmark::DoNotOptimize(polyglot::split_tabs(s)); });
+}
+
+// ---- trim / lower ----
+
+void BM_trim_manifest(benchmark::State& state) {
+  over(state, corpus().raw_fields, [](const std::string& s) { benchmark::DoNotOptimize(polyglot::trim(s)); });
+}
+void BM_trim_worst_padding(benchmark::State& state) {
+  const std::string pad(kWorstSize / 2, ' ');
+  once(state, pad + "x" + pad, [](const std::string& s) { benchmark::DoNotOptimize(polyglot::trim(s)); });
+}
+void BM_lower_manifest(benchmark::State& state) {
+  over(state, corpus().raw_fields, [](const std::string& s) { benchmark::DoNotOptimize(polyglot::lower(s)); });
+}
+void BM_lower_worst_upper(benchmark::State& state) {
+  once(state, std::string(kWorstSize, 'Q'), [](const std::string& s) { benchmark::DoNotOptimize(polyglot::lower(s)); });
+}
+
+// ---- unescape / json_escape ----
+
+void BM_unescape_manifest(benchmark::State& state) {
+  over(state, corpus().raw_fields, [](const std::string& s) { benchmark::DoNotOptimize(polyglot::unescape(s)); });
+}
+void BM_unescape_largest_field(benchmark::State& state) {
+  once(state, corpus().largest_raw, [](const std::string& s) { benchmark::DoNotOptimize(polyglot::unescape(s)); });
+}
+void BM_unescape_worst_all_escapes(benchmark::State& state) {
+  once(state, repeat("\\n\\t\\\"", kWorstSize), [](const std::string& s) { benchmark::DoNotOptimize(polyglot::unescape(s)); });
+}
+void BM_json_escape_manifest(benchmark::State& state) {
+  over(state, corpus().commands, [](const std::string& s) { benchmark::DoNotOptimize(polyglot::json_escape(s)); });
+}
+void BM_json_escape_worst_control(benchmark::State& state) {
+  // Control bytes other than \n \r \t take the \uXXXX path.
+  once(state, repeat("\x01\x02\x1f", kWorstSize), [](const std::string& s) { benchmark::DoNotOptimize(polyglot::json_escape(s)); });
+}
+
+// ---- shellish_split ----
+
+void BM_shellish_split_manifest(benchmark::State& state) {
+  over(state, corpus().commands, [](const std::string& s) { benchmark::DoNotOptimize(polyglot::shellish_split(s)); });
+}
+void BM_shellish_split_largest_command(benchmark::State& state) {
+  once(state, corpus().largest, [](const std::string& s) { benchmark::DoNotOptimize(polyglot::shellish_split(s)); });
+}
+void BM_shellish_split_worst_quoting(benchmark::State& state) {
+  once(state, repeat("'a b' \"c\\\"d\" e\\ f ", kWorstSize), [](const std::string& s) { benchmark::DoNotOptimize(polyglot::shellish_split(s)); });
+}
+
+// ---- icontains / replace_all ----
+
+void BM_icontains_manifest(benchmark::State& state) {
+  // The needles apply_fixups looks for.
+  over(state, corpus().commands, [](const std::string& s) {
+    benchmark::DoNotOptimize(polyglot::icontains(s, "cobc"));
+    benchmark::DoNotOptimize(polyglot::icontains(s, "-free"));
+  });
+}
+void BM_icontains_worst_near_miss(benchmark::State& state) {
+  const std::string needle = std::string(64, 'a') + "b";
+  once(state, std::string(kWorstSize, 'A'), [&](const std::string& s) { benchmark::DoNotOptimize(polyglot::icontains(s, needle)); });
+}
+void BM_replace_all_manifest(benchmark::State& state) {
+  over(state, corpus().commands, [](const std::string& s) {
+    std::string t = s;
+    polyglot::replace_all(t, "cobc -", "cobc -free -");
+    benchmark::DoNotOptimize(t);
+  });
+}
+void BM_replace_all_worst_growing(benchmark::State& state) {
+  // Every position matches and the replacement is longer: each replace shifts the tail.
+  once(state, std::string(kWorstSize / 8, 'a'), [](const std::string& s) {
+    std::string t = s;
+    polyglot::replace_all(t, "a", "bb");
+    benchmark::DoNotOptimize(t);
+  });
+}
+
+}  // namespace
+
+BENCHMARK(BM_split_tabs_manifest);
+BENCHMARK(BM_split_tabs_worst_all_tabs);
+BENCHMARK(BM_split_tabs_worst_no_tabs);
+BENCHMARK(BM_trim_manifest);
+BENCHMARK(BM_trim_worst_padding);
+BENCHMARK(BM_lower_manifest);
+BENCHMARK(BM_lower_worst_upper);
+BENCHMARK(BM_unescape_manifest);
+BENCHMARK(BM_unescape_largest_field);
+BENCHMARK(BM_unescape_worst_all_escapes);
+BENCHMARK(BM_json_escape_manifest);
+BENCHMARK(BM_json_escape_worst_control);
+BENCHMARK(BM_shellish_split_manifest);
+BENCHMARK(BM_shellish_split_largest_command);
+BENCHMARK(BM_shellish_split_worst_quoting);
+BENCHMARK(BM_icontains_manifest);
+BENCHMARK(BM_icontains_worst_near_miss);
+BENCHMARK(BM_replace_all_manifest);
+BENCHMARK(BM_replace_all_worst_growing);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../libpolyglot/sweep.hpp"
+
+// overhead: what the sweep runner costs per job when the jobs themselves cost nothing.
+//
+// Every phase runs `true` through the same spawn/capture path the Docker backend uses,
+// so what's left is the runner: spawning, output capture, bookkeeping and reporting.
+// Fails if the mean runner CPU per job or the p95 added latency (ready -> exec plus
+// exit -> recorded) exceeds its budget, so CI catches a runner that got heavier.
+//
+//   c++ -std=c++17 -O2 -pthread -o overhead_bench tools/bench/overhead.cpp tools/libpolyglot/*.cpp
+//   ./overhead_bench --jobs 1 --count 500 --max-cpu-us 500 --max-latency-us 2000
+
+namespace {
+
+class TrueBackend : public polyglot::SweepBackend {
+ public:
+  polyglot::PhaseResult run(const std::string&, const std::string&, const polyglot::Placement&) override {
+    return polyglot::spawn_phase({"true"}, nullptr);
+  }
+};
+
+double p95(std::vector<double> v) {
+  if (v.empty()) return 0;
+  std::sort(v.begin(), v.end());
+  return v[(size_t)(0.95 * (double)(v.size() - 1) + 0.5)];
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  try {
+    unsigned jobs = 1;
+    size_t count = 500;
+    double max_cpu_us = 500, max_latency_us = 2000;
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      if (arg == "--jobs" && i + 1 < argc) jobs = (unsigned)std::max(1, std::atoi(argv[++i]));
+      else if (arg == "--count" && i + 1 < argc) count = std::strtoull(argv[++i], nullptr, 10);
+      else if (arg == "--max-cpu-us" && i + 1 < argc) max_cpu_us = std::atof(argv[++i]);
+      else if (arg == "--max-latency-us" && i + 1 < argc) max_latency_us = std::atof(argv[++i]);
+      else {
+        std::cerr << "Usage: overhead_bench [--jobs N] [--count N] [--max-cpu-us X] [--max-latency-us X]\n";
+        return 2;
+      }
+    }
+
+    std::vector<std::string> slugs;
+    for (size_t i = 0; i < count; ++i) slugs.push_back("job" + std::to_string(i));
+    TrueBackend backend;
+    polyglot::SweepOptions opts;
+    opts.jobs = jobs;
+    polyglot::SweepOverhead overhead;
+    size_t reported = 0;
+    polyglot::run_sweep(slugs, backend, opts, [&](const polyglot::JobResult&) { ++reported; }, &overhead);
+    if (reported != count) throw std::runtime_error("sweep reported " + std::to_string(reported) + " jobs");
+
+    double cpu = 0;
+    for (double us : overhead.cpu_us) cpu += us;
+    cpu /= (double)std::max<size_t>(1, overhead.jobs);
+    // Per job: both phases' launch gaps plus the final record step.
+    std::vector<double> added;
+    for (size_t i = 0; i < overhead.launch_us.size() && i < overhead.record_us.size(); ++i) {
+      added.push_back(overhead.launch_us[i] + overhead.record_us[i]);
+    }
+    const double latency = p95(added);
+
+    std::printf("%s\n", overhead.summary().c_str());
+    std::printf("per job: cpu %.0f us (budget %.0f), added latency p95 %.0f us (budget %.0f)\n", cpu, max_cpu_us,
+                latency, max_latency_us);
+    if (cpu > max_cpu_us || latency > max_latency_us) {
+      std::printf("FAIL: runner overhead over budget\n");
+      return 1;
+    }
+    return 0;
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n";
+    return 1;
+  }
+}
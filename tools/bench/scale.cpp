@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/ptrace.h>
+#endif
+
+#include "../libpolyglot/tree.hpp"
+#include "synthetic.hpp"
+
+namespace fs = std::filesystem;
+
+// scale: end-to-end scaffold runs on synthetic manifests of growing size, on tmpfs.
+//
+// For each size it generates a manifest (see synthetic.hpp), runs scaffold into an empty
+// directory and records wall time (best of --repeat), peak RSS and, with ptrace, the
+// number of syscalls. It fails if time grows faster than rows: the log-log slope between
+// any two consecutive sizes above --max-slope (default 1.2) means superlinear scaling.
+//
+//   c++ -std=c++17 -O2 -o scale_bench tools/bench/scale.cpp tools/libpolyglot/*.cpp
+//   ./scale_bench --scaffold ./scaffold --sizes 1000,10000,100000
+
+struct Run {
+  double seconds = 0;
+  long max_rss_kb = 0;
+};
+
+// Runs scaffold on dir/languages.tsv from inside dir, output discarded.
+static Run run_scaffold(const fs::path& scaffold, const fs::path& dir) {
+  const auto t0 = std::chrono::steady_clock::now();
+  pid_t pid = fork();
+  if (pid < 0) throw std::runtime_error("fork failed");
+  if (pid == 0) {
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, 1);
+    if (chdir(dir.c_str()) != 0) _exit(127);
+    execl(scaffold.c_str(), scaffold.c_str(), "languages.tsv", (char*)nullptr);
+    _exit(127);
+  }
+  int status = 0;
+  struct rusage ru;
+  if (wait4(pid, &status, 0, &ru) < 0) throw std::runtime_error("wait4 failed");
+  const auto t1 = std::chrono::steady_clock::now();
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) throw std::runtime_error("scaffold failed in " + dir.string());
+
+  Run r;
+  r.seconds = std::chrono::duration<double>(t1 - t0).count();
+  r.max_rss_kb = ru.ru_maxrss;
+  return r;
+}
+
+// Same run under ptrace, counting syscall entries. -1 where ptrace isn't available.
+static long count_syscalls(const fs::path& scaffold, const fs::path& dir) {
+#ifdef __linux__
+  pid_t pid = fork();
+  if (pid < 0) return -1;
+  if (pid == 0) {
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, 1);
+    if (chdir(dir.c_str()) != 0) _exit(127);
+    if (ptrace(PTRACE_TRACEME, 0, nullptr, nullptr) != 0) _exit(126);
+    execl(scaffold.c_str(), scaffold.c_str(), "languages.tsv", (char*)nullptr);
+    _exit(127);
+  }
+  int status = 0;
+  if (waitpid(pid, &status, 0) < 0 || !WIFSTOPPED(status)) {
+    waitpid(pid, &status, 0);
+    return -1;  // TRACEME refused (e.g. in a container without CAP_SYS_PTRACE)
+  }
+  ptrace(PTRACE_SETOPTIONS, pid, nullptr, (void*)(long)(PTRACE_O_TRACESYSGOOD | PTRACE_O_EXITKILL));
+  long stops = 0;
+  int sig = 0;
+  for (;;) {
+    if (ptrace(PTRACE_SYSCALL, pid, nullptr, (void*)(long)sig) != 0) break;
+    if (waitpid(pid, &status, 0) < 0 || WIFEXITED(status) || WIFSIGNALED(status)) break;
+    sig = 0;
+    if (WSTOPSIG(status) == (SIGTRAP | 0x80)) ++stops;
+    else if (WSTOPSIG(status) != SIGTRAP) sig = WSTOPSIG(status);
+  }
+  return (stops + 1) / 2;  // one stop on entry, one on exit (exit_group has no exit stop)
+#else
+  (void)scaffold;
+  (void)dir;
+  return -1;
+#endif
+}
+
+static void clean(const fs::path& dir) {
+  std::error_code ec;
+  fs::remove_all(dir / "languages", ec);
+  fs::remove_all(dir / ".polyglot", ec);
+}
+
+int main(int argc, char** argv) {
+  try {
+    fs::path scaffold = "./scaffold";
+    fs::path source = "languages.tsv";
+    std::vector<size_t> sizes = {1000, 10000, 100000};
+    fs::path base = fs::exists("/dev/shm") ? fs::path("/dev/shm") : fs::temp_directory_path();
+    int repeat = 3;
+    double max_slope = 1.2;
+    bool syscalls = true;
+
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      if (arg == "--scaffold" && i + 1 < argc) scaffold = argv[++i];
+      else if (arg == "--manifest" && i + 1 < argc) source = argv[++i];
+      else if (arg == "--dir" && i + 1 < argc) base = argv[++i];
+      else if (arg == "--repeat" && i + 1 < argc) repeat = std::max(1, std::atoi(argv[++i]));
+      else if (arg == "--max-slope" && i + 1 < argc) max_slope = std::atof(argv[++i]);
+      else if (arg == "--no-syscalls") syscalls = false;
+      else if (arg == "--sizes" && i + 1 < argc) {
+        sizes.clear();
+        std::stringstream ss(argv[++i]);
+        for (std::string n; std::getline(ss, n, ',');) sizes.push_back(std::strtoull(n.c_str(), nullptr, 10));
+        std::sort(sizes.begin(), sizes.end());
+      } else {
+        std::cerr << "Usage: scale_bench [--scaffold PATH] [--manifest languages.tsv] [--sizes 1000,10000,100000]\n"
+                     "                   [--dir DIR] [--repeat N] [--max-slope X] [--no-syscalls]\n";
+        return 2;
+      }
+    }
+    scaffold = fs::absolute(scaffold);
+    if (!fs::exists(scaffold)) throw std::runtime_error("No scaffold binary at " + scaffold.string());
+    const std::string seed_text = polyglot::read_file_or_empty(source);
+    if (seed_text.empty()) throw std::runtime_error("Cannot read manifest: " + source.string());
+
+    const fs::path dir = base / ("polyglot-scale-" + std::to_string(getpid()));
+    fs::create_directories(dir);
+
+    std::printf("%10s %10s %10s %10s %14s\n", "rows", "seconds", "us/row", "peak MiB", "syscalls/row");
+    std::vector<double> times;
+    for (size_t rows : sizes) {
+      polyglot::write_file_if_changed(dir / "languages.tsv", bench::synthetic_manifest(seed_text, rows, 1));
+      Run best;
+      for (int r = 0; r < repeat; ++r) {
+        clean(dir);
+        const Run run = run_scaffold(scaffold, dir);
+        if (r == 0 || run.seconds < best.seconds) best.seconds = run.seconds;
+        best.max_rss_kb = std::max(best.max_rss_kb, run.max_rss_kb);
+      }
+      long calls = -1;
+      if (syscalls) {
+        clean(dir);
+        calls = count_syscalls(scaffold, dir);
+      }
+      times.push_back(best.seconds);
+
+      char per_row[32] = "n/a";
+      if (calls >= 0) std::snprintf(per_row, sizeof(per_row), "%.1f", (double)calls / (double)rows);
+      std::printf("%10zu %10.3f %10.1f %10.1f %14s\n", rows, best.seconds, best.seconds * 1e6 / (double)rows,
+                  best.max_rss_kb / 1024.0, per_row);
+      std::fflush(stdout);
+    }
+    clean(dir);
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+
+    bool ok = true;
+    for (size_t i = 1; i < sizes.size(); ++i) {
+      if (sizes[i] == sizes[i - 1] || times[i - 1] <= 0) continue;
+      const double slope = std::log(times[i] / times[i - 1]) / std::log((double)sizes[i] / (double)sizes[i - 1]);
+      std::printf("scaling %zu -> %zu rows: slope %.2f%s\n", sizes[i - 1], sizes[i], slope,
+                  slope > max_slope ? "  SUPERLINEAR" : "");
+      if (slope > max_slope) ok = false;
+    }
+    if (!ok) {
+      std::printf("FAIL: scaffold time grows faster than rows (max slope %.2f)\n", max_slope);
+      return 1;
+    }
+    return 0;
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n";
+    return 1;
+  }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../libpolyglot/text.hpp"
+
+// Synthetic manifests for scaling benchmarks: n rows sampled (with replacement) from a
+// real manifest. Only the slug changes, gaining a version/profile suffix so every row
+// is unique; all other fields are copied verbatim, escapes included. Field lengths,
+// escape density and heredoc-sized commands therefore follow the real distribution.
+namespace bench {
+
+inline std::string synthetic_manifest(const std::string& seed_text, size_t rows, uint64_t seed) {
+  static const char* const kProfiles[] = {"default", "slim", "debug", "static"};
+
+  std::istringstream in(seed_text);
+  std::string header;
+  std::getline(in, header);
+  size_t slug_col = 0;
+  const auto cols = polyglot::split_tabs(header);
+  bool has_header = false;
+  for (size_t i = 0; i < cols.size(); ++i) {
+    if (polyglot::lower(polyglot::trim(cols[i])) == "slug") {
+      slug_col = i;
+      has_header = true;
+    }
+  }
+
+  std::vector<std::vector<std::string>> pool;
+  auto take = [&](const std::string& line) {
+    const std::string t = polyglot::trim(line);
+    if (t.empty() || t[0] == '#') return;
+    pool.push_back(polyglot::split_tabs(line));
+  };
+  if (!has_header) take(header);
+  for (std::string line; std::getline(in, line);) take(line);
+  if (pool.empty()) return has_header ? header + "\n" : "";
+
+  std::string out;
+  if (has_header) out = header + "\n";
+  uint64_t x = seed ? seed : 0x9E3779B97F4A7C15ull;
+  for (size_t r = 0; r < rows; ++r) {
+    x ^= x << 13;  // xorshift64: deterministic for a given seed
+    x ^= x >> 7;
+    x ^= x << 17;
+    const auto& row = pool[x % pool.size()];
+    for (size_t c = 0; c < row.size(); ++c) {
+      if (c) out += '\t';
+      if (c == slug_col) {
+        out += polyglot::trim(row[c]) + "-v" + std::to_string(r / 4 % 1000) + "-" + kProfiles[r % 4] + "-" +
+               std::to_string(r);
+      } else {
+        out += row[c];
+      }
+    }
+    out += '\n';
+  }
+  return out;
+}
+
+}  // namespace bench
@@ -0,0 +1,178 @@
+#include "affected.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <unistd.h>
+
+#include "manifest.hpp"
+#include "render.hpp"
+#include "text.hpp"
+#include "tree.hpp"
+
+namespace fs = std::filesystem;
+
+namespace polyglot {
+
+const char* const kGeneratorSources[] = {
+  "tools/libpolyglot/manifest.cpp",   // parsing, fixups, filename resolution
+  "tools/libpolyglot/render.cpp",     // Dockerfile / run.sh templates
+  "tools/libpolyglot/text.cpp",       // unescaping and tokenizing
+  "tools/libpolyglot/resources.cpp",  // resource classes, Dockerfile width args
+  "tools/libpolyglot/stats.cpp",      // timing probes only, but render.cpp includes it
+};
+const size_t kGeneratorSourceCount = sizeof(kGeneratorSources) / sizeof(kGeneratorSources[0]);
+
+std::vector<std::string> unlisted_generator_sources() {
+  const std::string dir = "tools/libpolyglot/";
+  auto listed = [](const std::string& path) {
+    for (const char* src : kGeneratorSources) {
+      if (path == src) return true;
+    }
+    return false;
+  };
+  std::vector<std::string> out;
+  for (const char* entry : {"tools/libpolyglot/render.cpp", "tools/libpolyglot/manifest.cpp"}) {
+    std::istringstream in(read_file_or_empty(entry));
+    for (std::string line; std::getline(in, line);) {
+      // #include "name.hpp" with a name.cpp next to it.
+      const std::string tag = "#include \"";
+      if (line.compare(0, tag.size(), tag) != 0) continue;
+      const size_t end = line.find(".hpp\"", tag.size());
+      if (end == std::string::npos) continue;
+      const std::string src = dir + line.substr(tag.size(), end - tag.size()) + ".cpp";
+      std::error_code ec;
+      if (fs::exists(src, ec) && !listed(src) && std::find(out.begin(), out.end(), src) == out.end()) {
+        out.push_back(src);
+      }
+    }
+  }
+  return out;
+}
+
+// Runs a shell command and returns its stdout; sets ok to whether it exited 0.
+static std::string capture(const std::string& cmd, bool& ok) {
+  std::string out;
+  FILE* p = popen(cmd.c_str(), "r");
+  if (!p) throw std::runtime_error("Failed to run: " + cmd);
+  char buf[65536];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), p)) > 0) out.append(buf, n);
+  ok = (pclose(p) == 0);
+  return out;
+}
+
+// Reads many blobs at one revision through a single `git cat-file --batch`.
+// Paths missing at that revision are absent from the result.
+static std::unordered_map<std::string, std::string> git_read_blobs(const std::string& rev,
+                                                                   const std::vector<std::string>& paths) {
+  std::unordered_map<std::string, std::string> blobs;
+  if (paths.empty()) return blobs;
+
+  // pid plus a per-process counter: scaffold serve runs several of these at once.
+  static std::atomic<unsigned> seq{0};
+  const fs::path req = fs::temp_directory_path() /
+                       ("scaffold-affected-" + std::to_string(::getpid()) + "-" + std::to_string(seq++));
+  {
+    std::ofstream f(req, std::ios::binary);
+    if (!f) throw std::runtime_error("Failed to write: " + req.string());
+    for (const auto& p : paths) f << rev << ":" << p << "\n";
+  }
+  bool ok = false;
+  const std::string raw = capture("git cat-file --batch < " + shell_quote(req.string()), ok);
+  std::error_code ec;
+  fs::remove(req, ec);
+  if (!ok) throw std::runtime_error("git cat-file failed for revision " + rev);
+
+  // Responses come back in request order: "<sha> blob <size>\n<bytes>\n" or "<req> missing\n".
+  size_t pos = 0;
+  for (const auto& p : paths) {
+    size_t eol = raw.find('\n', pos);
+    if (eol == std::string::npos) break;
+    const std::string head = raw.substr(pos, eol - pos);
+    pos = eol + 1;
+    if (ends_with(head, " missing")) continue;
+    const size_t size = std::stoull(head.substr(head.rfind(' ') + 1));
+    blobs[p] = raw.substr(pos, size);
+    pos += size + 1;
+  }
+  return blobs;
+}
+
+std::vector<std::string> affected_slugs(const fs::path& manifest, const std::string& rev) {
+  return affected_slugs(Manifest::load(manifest), manifest, rev);
+}
+
+std::vector<std::string> affected_slugs(const Manifest& current, const fs::path& manifest,
+                                        const std::string& rev) {
+  bool ok = false;
+  const std::string prefix = trim(capture("git rev-parse --show-prefix", ok));
+  if (!ok) throw std::runtime_error("Not inside a git work tree");
+  // A typo must not read as "manifest didn't exist", which would select every slug.
+  capture("git rev-parse --quiet --verify " + shell_quote(rev + "^{commit}") + " >/dev/null", ok);
+  if (!ok) throw std::runtime_error("Unknown revision: " + rev);
+
+  const std::string rel = fs::relative(fs::absolute(manifest)).generic_string();
+  std::string old_text = capture("git show " + shell_quote(rev + ":./" + rel) + " 2>/dev/null", ok);
+  if (!ok) old_text.clear(); // manifest didn't exist at rev: everything is new
+  const Manifest previous = Manifest::parse(old_text);
+
+  std::unordered_map<std::string, std::vector<Artifact>> before;
+  for (const auto& slug : previous.slugs()) before[slug] = render(*previous.find(slug));
+  std::unordered_map<std::string, std::vector<Artifact>> after;
+  for (const auto& slug : current.slugs()) after[slug] = render(*current.find(slug));
+
+  auto same = [](const std::vector<Artifact>& a, const std::vector<Artifact>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+      if (a[i].name != b[i].name || a[i].content != b[i].content) return false;
+    }
+    return true;
+  };
+
+  bool generator_changed = false;
+  for (const char* src : kGeneratorSources) {
+    capture("git diff --quiet " + shell_quote(rev) + " -- " + shell_quote(std::string(":/") + src), ok);
+    if (!ok) generator_changed = true;
+  }
+
+  std::unordered_map<std::string, std::string> committed;
+  if (generator_changed) {
+    std::vector<std::string> paths;
+    for (const auto& [slug, arts] : after) {
+      for (const auto& a : arts) paths.push_back(prefix + "languages/" + slug + "/" + a.name);
+    }
+    committed = git_read_blobs(rev, paths);
+  }
+
+  std::vector<std::string> out;
+  for (const auto& slug : current.slugs()) {
+    const auto& arts = after[slug];
+
+    bool changed = false;
+    auto it = before.find(slug);
+    if (it == before.end() || !same(it->second, arts)) changed = true;
+
+    if (!changed && generator_changed) {
+      for (const auto& a : arts) {
+        auto c = committed.find(prefix + "languages/" + slug + "/" + a.name);
+        if (c == committed.end() || c->second != a.content) { changed = true; break; }
+      }
+    }
+
+    if (changed) out.push_back(slug);
+  }
+
+  for (const auto& [slug, arts] : before) {
+    if (!after.count(slug)) std::cerr << "Removed from manifest: " << slug << "\n";
+  }
+  return out;
+}
+
+}  // namespace polyglot
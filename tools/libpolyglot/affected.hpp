@@ -0,0 +1,29 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "manifest.hpp"
+
+namespace polyglot {
+
+// Sources whose edits can change generated output for every row (fixups, templates).
+extern const char* const kGeneratorSources[];
+extern const size_t kGeneratorSourceCount;
+
+// libpolyglot sources render.cpp or manifest.cpp include that kGeneratorSources lacks
+// (paths relative to the repo root, which must be the current directory). Outside the
+// repo, where those files don't exist, always empty.
+std::vector<std::string> unlisted_generator_sources();
+
+// Slugs (in manifest order) whose generated artifacts differ between the working tree
+// and `rev`. Rows are diffed by slug; if the generator itself changed since `rev`, the
+// current rendering is also compared against the languages/ tree committed at `rev`.
+// Must run inside the git work tree; languages/ is taken relative to the current directory.
+std::vector<std::string> affected_slugs(const std::filesystem::path& manifest, const std::string& rev);
+// Same, against an already parsed `current` (which must be what `manifest` holds).
+std::vector<std::string> affected_slugs(const Manifest& current, const std::filesystem::path& manifest,
+                                        const std::string& rev);
+
+}  // namespace polyglot
@@ -0,0 +1,185 @@
+#include "archive.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include "text.hpp"
+#include "tree.hpp"
+
+namespace polyglot {
+
+static constexpr size_t kBlock = 512;
+
+// width - 1 zero-padded octal digits and a NUL; the value must fit.
+static void put_octal(char* field, size_t width, unsigned long long v) {
+  char buf[24];
+  const int n = std::snprintf(buf, sizeof(buf), "%0*llo", (int)(width - 1), v);
+  if (n < 0 || (size_t)n >= width) throw std::runtime_error("Value too large for tar header");
+  std::memcpy(field, buf, (size_t)n + 1);
+}
+
+void TarWriter::header(const std::string& path, size_t size, unsigned mode, char type) {
+  char h[kBlock];
+  std::memset(h, 0, sizeof(h));
+
+  // ustar splits long names into prefix (155) + '/' + name (100).
+  std::string name = path, prefix;
+  if (name.size() > 100) {
+    size_t cut = name.rfind('/', 155);
+    if (cut == std::string::npos || name.size() - cut - 1 > 100) {
+      throw std::runtime_error("Path too long for tar: " + path);
+    }
+    prefix = name.substr(0, cut);
+    name = name.substr(cut + 1);
+  }
+  std::memcpy(h, name.data(), name.size());
+  put_octal(h + 100, 8, mode);
+  put_octal(h + 108, 8, 0);   // uid
+  put_octal(h + 116, 8, 0);   // gid
+  put_octal(h + 124, 12, size);
+  put_octal(h + 136, 12, 0);  // mtime
+  h[156] = type;
+  std::memcpy(h + 257, "ustar", 6);
+  std::memcpy(h + 263, "00", 2);
+  std::memcpy(h + 345, prefix.data(), prefix.size());
+
+  // Checksum is computed with its own field as spaces.
+  std::memset(h + 148, ' ', 8);
+  unsigned sum = 0;
+  for (unsigned char c : h) sum += c;
+  std::snprintf(h + 148, 8, "%06o", sum);
+
+  out_.append(h, kBlock);
+}
+
+void TarWriter::add_dir(const std::string& path) {
+  header(path + "/", 0, 0755, '5');
+}
+
+void TarWriter::add_file(const std::string& path, const std::string& content, bool executable) {
+  header(path, content.size(), executable ? 0755 : 0644, '0');
+  out_ += content;
+  out_.append((kBlock - content.size() % kBlock) % kBlock, '\0');
+}
+
+void TarWriter::add_slug(const std::string& slug, const std::vector<Artifact>& artifacts) {
+  const std::string dir = "languages/" + slug;
+  add_dir(dir);
+  for (const auto& a : artifacts) add_file(dir + "/" + a.name, a.content, a.executable);
+}
+
+std::string TarWriter::finish() {
+  out_.append(2 * kBlock, '\0');
+  return std::move(out_);
+}
+
+static unsigned long long get_octal(const char* field, size_t width) {
+  unsigned long long v = 0;
+  for (size_t i = 0; i < width && field[i]; ++i) {
+    if (field[i] == ' ') continue;
+    if (field[i] < '0' || field[i] > '7') break;
+    v = v * 8 + (unsigned)(field[i] - '0');
+  }
+  return v;
+}
+
+static std::string get_string(const char* field, size_t width) {
+  return std::string(field, strnlen(field, width));
+}
+
+std::vector<TarEntry> read_tar(const std::string& data) {
+  std::vector<TarEntry> entries;
+  size_t pos = 0;
+  while (pos + kBlock <= data.size()) {
+    const char* h = data.data() + pos;
+    if (h[0] == '\0') break;  // end-of-archive marker
+    const size_t size = get_octal(h + 124, 12);
+    const char type = h[156];
+    pos += kBlock;
+    if (pos + size > data.size()) throw std::runtime_error("Truncated tar archive");
+
+    std::string path = get_string(h, 100);
+    if (std::memcmp(h + 257, "ustar", 5) == 0) {
+      const std::string prefix = get_string(h + 345, 155);
+      if (!prefix.empty()) path = prefix + "/" + path;
+    }
+    while (!path.empty() && path.back() == '/') path.pop_back();
+    if (path.rfind("./", 0) == 0) path.erase(0, 2);
+
+    if (type == '5' || type == '0' || type == '\0') {
+      TarEntry e;
+      e.path = path;
+      e.mode = (unsigned)get_octal(h + 100, 8) & 07777;
+      e.dir = type == '5';
+      if (!e.dir) e.content = data.substr(pos, size);
+      entries.push_back(std::move(e));
+    }
+    pos += (size + kBlock - 1) / kBlock * kBlock;
+  }
+  return entries;
+}
+
+static bool is_zst(const std::filesystem::path& p) {
+  return p.extension() == ".zst";
+}
+
+void write_archive(const std::filesystem::path& path, const std::string& tar) {
+  if (!is_zst(path)) {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) throw std::runtime_error("Failed to write: " + path.string());
+    const bool ok = std::fwrite(tar.data(), 1, tar.size(), f) == tar.size();
+    if (std::fclose(f) != 0 || !ok) throw std::runtime_error("Failed to write: " + path.string());
+    return;
+  }
+  const std::string cmd = "zstd -q -f -o " + shell_quote(path.string());
+  FILE* p = popen(cmd.c_str(), "w");
+  if (!p) throw std::runtime_error("Failed to run: " + cmd);
+  const bool ok = std::fwrite(tar.data(), 1, tar.size(), p) == tar.size();
+  if (pclose(p) != 0 || !ok) throw std::runtime_error("zstd failed writing " + path.string());
+}
+
+std::string read_archive(const std::filesystem::path& path) {
+  if (!is_zst(path)) {
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) throw std::runtime_error("Cannot open archive: " + path.string());
+    return read_file_or_empty(path);
+  }
+  const std::string cmd = "zstd -q -d -c " + shell_quote(path.string());
+  FILE* p = popen(cmd.c_str(), "r");
+  if (!p) throw std::runtime_error("Failed to run: " + cmd);
+  std::string out;
+  char buf[65536];
+  size_t n;
+  while ((n = std::fread(buf, 1, sizeof(buf), p)) > 0) out.append(buf, n);
+  if (pclose(p) != 0) throw std::runtime_error("zstd failed reading " + path.string());
+  return out;
+}
+
+std::vector<std::string> archive_slugs(const std::vector<TarEntry>& entries) {
+  std::vector<std::string> slugs;
+  for (const auto& e : entries) {
+    if (e.dir && e.path.rfind("languages/", 0) == 0 && e.path.find('/', 10) == std::string::npos) {
+      slugs.push_back(e.path.substr(10));
+    }
+  }
+  return slugs;
+}
+
+std::string build_context(const std::vector<TarEntry>& entries, const std::string& slug) {
+  const std::string dir = "languages/" + slug + "/";
+  TarWriter w;
+  bool found = false;
+  for (const auto& e : entries) {
+    if (e.path + "/" == dir) found = true;
+    if (e.path.rfind(dir, 0) != 0) continue;
+    found = true;
+    const std::string rel = e.path.substr(dir.size());
+    if (e.dir) w.add_dir(rel);
+    else w.add_file(rel, e.content, (e.mode & 0111) != 0);
+  }
+  if (!found) throw std::runtime_error("Not in archive: " + slug);
+  return w.finish();
+}
+
+}  // namespace polyglot
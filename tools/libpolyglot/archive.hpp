@@ -0,0 +1,56 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "render.hpp"
+
+namespace polyglot {
+
+// ---- ustar archives of the generated tree ----
+//
+// scaffold --output-archive writes languages/<slug>/<file> for every row into one tar
+// (zstd-compressed when the name ends in .zst, via the zstd CLI) in a single write.
+// Entries are deterministic: uid/gid 0, mtime 0, modes 0755 for directories and
+// executables, 0644 otherwise, so identical input gives a byte-identical archive.
+
+struct TarEntry {
+  std::string path;     // '/'-separated; directories end without a slash
+  std::string content;  // empty for directories
+  unsigned mode = 0644;
+  bool dir = false;
+};
+
+class TarWriter {
+ public:
+  void add_dir(const std::string& path);
+  void add_file(const std::string& path, const std::string& content, bool executable);
+  // Adds languages/<slug>/ and its artifacts.
+  void add_slug(const std::string& slug, const std::vector<Artifact>& artifacts);
+
+  // Appends the end-of-archive marker and returns the finished tar.
+  std::string finish();
+
+ private:
+  void header(const std::string& path, size_t size, unsigned mode, char type);
+
+  std::string out_;
+};
+
+// Parses a tar produced by TarWriter (or any plain ustar/v7 tar). Other entry types
+// (links, pax headers) are skipped.
+std::vector<TarEntry> read_tar(const std::string& data);
+
+// Writes/reads an archive file, compressing or decompressing with zstd for *.zst.
+void write_archive(const std::filesystem::path& path, const std::string& tar);
+std::string read_archive(const std::filesystem::path& path);
+
+// Slugs present in an archive (languages/<slug>/ directories), in archive order.
+std::vector<std::string> archive_slugs(const std::vector<TarEntry>& entries);
+
+// A docker build context for one slug: its entries re-rooted at the top of a new tar,
+// ready for `docker build -`. Throws if the slug isn't in the archive.
+std::string build_context(const std::vector<TarEntry>& entries, const std::string& slug);
+
+}  // namespace polyglot
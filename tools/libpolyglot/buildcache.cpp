@@ -0,0 +1,214 @@
+#include "buildcache.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <map>
+#include <set>
+#include <sstream>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "tree.hpp"
+
+namespace fs = std::filesystem;
+
+namespace polyglot {
+
+std::vector<std::string> build_cache_args(const fs::path& dir, const std::string& slug) {
+  const fs::path cache = dir / slug;
+  std::vector<std::string> args;
+  std::error_code ec;
+  if (fs::exists(cache / "index.json", ec)) args.insert(args.end(), {"--cache-from", "type=local,src=" + cache.string()});
+  args.insert(args.end(), {"--cache-to", "type=local,dest=" + cache.string(), "--load"});
+  return args;
+}
+
+namespace {
+
+bool starts_with(const std::string& s, const char* prefix) { return s.compare(0, std::strlen(prefix), prefix) == 0; }
+
+// "#7 [stage 3/4] RUN ..." -> id "7", instruction "RUN"; false for other lines.
+bool buildkit_step(const std::string& line, std::string& id, std::string& instruction) {
+  if (line.size() < 2 || line[0] != '#' || !std::isdigit((unsigned char)line[1])) return false;
+  const size_t sp = line.find(' ');
+  if (sp == std::string::npos || line.compare(sp, 2, " [") != 0) return false;
+  const size_t close = line.find(']', sp);
+  if (close == std::string::npos) return false;
+  // The bracket holds "k/n", optionally after a stage or platform name.
+  const std::string bracket = line.substr(sp + 2, close - sp - 2);
+  const size_t slash = bracket.rfind('/');
+  if (slash == std::string::npos || slash == 0 || !std::isdigit((unsigned char)bracket[slash - 1]) ||
+      slash + 1 >= bracket.size() || !std::isdigit((unsigned char)bracket[slash + 1])) {
+    return false;
+  }
+  id = line.substr(1, sp - 1);
+  std::istringstream rest(line.substr(close + 1));
+  rest >> instruction;
+  return true;
+}
+
+}  // namespace
+
+CacheSteps cache_steps(const std::string& build_output) {
+  CacheSteps r;
+  std::set<std::string> steps, cached;
+  std::istringstream in(build_output);
+  bool classic_step = false;
+  for (std::string line; std::getline(in, line);) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    std::string id, instruction;
+    if (buildkit_step(line, id, instruction)) {
+      if (instruction != "FROM") steps.insert(id);
+    } else if (line.size() > 8 && line[0] == '#' && line.compare(line.size() - 7, 7, " CACHED") == 0) {
+      cached.insert(line.substr(1, line.size() - 8));
+    } else if (starts_with(line, "Step ")) {
+      const size_t colon = line.find(" : ");
+      classic_step = colon != std::string::npos && line.compare(colon + 3, 5, "FROM ") != 0;
+      if (classic_step) ++r.steps;
+    } else if (classic_step && line.find("---> Using cache") != std::string::npos) {
+      ++r.cached;
+      classic_step = false;
+    }
+  }
+  r.steps += steps.size();
+  for (const auto& id : cached) r.cached += steps.count(id);
+  return r;
+}
+
+namespace {
+
+struct Blob {
+  fs::path path;
+  std::string digest;  // hex
+  uint64_t size = 0;
+  dev_t dev = 0;
+  ino_t ino = 0;
+};
+
+// Every "sha256:<64 hex>" in a JSON document.
+std::vector<std::string> digests_in(const std::string& text) {
+  std::vector<std::string> out;
+  for (size_t at = text.find("sha256:"); at != std::string::npos; at = text.find("sha256:", at + 7)) {
+    const std::string hex = text.substr(at + 7, 64);
+    if (hex.size() == 64 && std::all_of(hex.begin(), hex.end(), [](char c) { return std::isxdigit((unsigned char)c); }))
+      out.push_back(hex);
+  }
+  return out;
+}
+
+// Blobs reachable from a slug's index.json: manifests and cache configs are JSON and
+// name further blobs; layers are leaves.
+std::set<std::string> reachable(const fs::path& slug_dir) {
+  std::set<std::string> seen;
+  std::vector<std::string> todo = digests_in(read_file_or_empty(slug_dir / "index.json"));
+  while (!todo.empty()) {
+    const std::string hex = todo.back();
+    todo.pop_back();
+    if (!seen.insert(hex).second) continue;
+    const fs::path blob = slug_dir / "blobs" / "sha256" / hex;
+    std::error_code ec;
+    const auto size = fs::file_size(blob, ec);
+    if (ec || size > (4u << 20)) continue;
+    const std::string text = read_file_or_empty(blob);
+    const size_t first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos || text[first] != '{') continue;
+    for (auto& d : digests_in(text)) todo.push_back(std::move(d));
+  }
+  return seen;
+}
+
+std::vector<Blob> blobs_of(const fs::path& slug_dir) {
+  std::vector<Blob> out;
+  std::error_code ec;
+  for (const auto& e : fs::directory_iterator(slug_dir / "blobs" / "sha256", ec)) {
+    struct stat st;
+    if (::stat(e.path().c_str(), &st) != 0 || !S_ISREG(st.st_mode)) continue;
+    out.push_back({e.path(), e.path().filename().string(), (uint64_t)st.st_size, st.st_dev, st.st_ino});
+  }
+  return out;
+}
+
+uint64_t unique_bytes(const std::map<std::string, std::vector<Blob>>& slugs) {
+  std::set<std::pair<dev_t, ino_t>> seen;
+  uint64_t total = 0;
+  for (const auto& [slug, blobs] : slugs) {
+    for (const auto& b : blobs) {
+      if (seen.insert({b.dev, b.ino}).second) total += b.size;
+    }
+  }
+  return total;
+}
+
+}  // namespace
+
+CachePrune prune_build_cache(const fs::path& dir, uint64_t budget) {
+  CachePrune r;
+  std::map<std::string, std::vector<Blob>> slugs;
+  std::map<std::string, fs::file_time_type> exported;
+  std::error_code ec;
+  for (const auto& e : fs::directory_iterator(dir, ec)) {
+    if (!e.is_directory()) continue;
+    const std::string slug = e.path().filename().string();
+    slugs[slug] = blobs_of(e.path());
+    exported[slug] = fs::last_write_time(e.path() / "index.json", ec);
+    if (ec) exported[slug] = fs::file_time_type::min();  // never finished an export
+  }
+  r.before = unique_bytes(slugs);
+
+  std::map<std::string, Blob> first;  // digest -> the copy others link to
+  for (auto& [slug, blobs] : slugs) {
+    const std::set<std::string> keep = reachable(dir / slug);
+    std::vector<Blob> kept;
+    for (auto& b : blobs) {
+      if (!keep.count(b.digest)) {
+        fs::remove(b.path, ec);
+        ++r.blobs_removed;
+        continue;
+      }
+      const auto [it, inserted] = first.emplace(b.digest, b);
+      if (!inserted && (it->second.ino != b.ino || it->second.dev != b.dev) && it->second.size == b.size) {
+        // Content-addressed, so same digest means same bytes. Link beside, then
+        // rename over, so the blob never goes missing.
+        const fs::path tmp = b.path.string() + ".link";
+        fs::remove(tmp, ec);
+        if (::link(it->second.path.c_str(), tmp.c_str()) == 0 && ::rename(tmp.c_str(), b.path.c_str()) == 0) {
+          b.dev = it->second.dev;
+          b.ino = it->second.ino;
+          ++r.blobs_linked;
+        } else {
+          fs::remove(tmp, ec);
+        }
+      }
+      kept.push_back(b);
+    }
+    blobs = std::move(kept);
+    if (blobs.empty() && exported[slug] == fs::file_time_type::min()) {
+      fs::remove_all(dir / slug, ec);
+      r.evicted.push_back(slug);
+    }
+  }
+  for (const auto& slug : r.evicted) {
+    slugs.erase(slug);
+    exported.erase(slug);
+  }
+
+  // Oldest export first; a blob's space only comes back with its last link.
+  std::vector<std::string> order;
+  for (const auto& [slug, blobs] : slugs) order.push_back(slug);
+  std::sort(order.begin(), order.end(),
+            [&](const std::string& a, const std::string& b) { return exported[a] < exported[b]; });
+  uint64_t total = unique_bytes(slugs);
+  for (const auto& slug : order) {
+    if (total <= budget) break;
+    fs::remove_all(dir / slug, ec);
+    slugs.erase(slug);
+    r.evicted.push_back(slug);
+    total = unique_bytes(slugs);
+  }
+  r.after = total;
+  return r;
+}
+
+}  // namespace polyglot
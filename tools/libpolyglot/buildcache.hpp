@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace polyglot {
+
+// ---- local BuildKit layer cache ----
+//
+// Fresh CI workers start with an empty layer cache. With $POLYGLOT_BUILD_CACHE set to
+// a directory, every build imports from and exports to a `type=local` BuildKit cache
+// under <dir>/<slug>/, an OCI layout (index.json + blobs/sha256/) that rsync or NFS
+// can carry between workers, no registry needed. One directory per slug keeps
+// concurrent builds from overwriting each other's index.json.
+
+// `docker build` flags for a slug's cache: --cache-from once it has been exported,
+// --cache-to always, and --load so the image still lands in the local store when the
+// builder isn't Docker's own (cache export needs a docker-container builder or the
+// containerd image store).
+std::vector<std::string> build_cache_args(const std::filesystem::path& dir, const std::string& slug);
+
+// Cacheable build steps (everything but FROM) in one build's output and how many were
+// cache hits. Reads BuildKit plain progress ("#7 [3/4] RUN ..." then "#7 CACHED") and
+// the classic builder's "Step 3/4 : RUN" / "---> Using cache".
+struct CacheSteps {
+  size_t steps = 0;
+  size_t cached = 0;
+};
+CacheSteps cache_steps(const std::string& build_output);
+
+struct CachePrune {
+  uint64_t before = 0;  // bytes on disk, hard-linked blobs counted once
+  uint64_t after = 0;
+  size_t blobs_removed = 0;       // not reachable from their slug's index.json
+  size_t blobs_linked = 0;        // identical blobs of different slugs hard-linked into one
+  std::vector<std::string> evicted;  // whole slugs dropped to meet the budget
+};
+
+// Keeps the cache directory bounded: removes blobs a slug's index.json no longer
+// reaches (exports never delete the previous ones), hard-links blobs that several
+// slugs share (base image layers), then evicts the slugs exported longest ago until
+// at most `budget` bytes remain. Run it while nothing is exporting.
+CachePrune prune_build_cache(const std::filesystem::path& dir, uint64_t budget);
+
+}  // namespace polyglot
@@ -0,0 +1,88 @@
+#include "polyglot.h"
+
+#include <exception>
+#include <string>
+
+#include "manifest.hpp"
+#include "render.hpp"
+
+struct pg_manifest {
+  polyglot::Manifest manifest;
+};
+
+static thread_local std::string g_last_error;
+
+extern "C" {
+
+pg_manifest* pg_manifest_open(const char* path) {
+  try {
+    return new pg_manifest{polyglot::Manifest::load(path)};
+  } catch (const std::exception& e) {
+    g_last_error = e.what();
+    return nullptr;
+  }
+}
+
+pg_manifest* pg_manifest_parse(const char* text, size_t len) {
+  try {
+    return new pg_manifest{polyglot::Manifest::parse(std::string(text, len))};
+  } catch (const std::exception& e) {
+    g_last_error = e.what();
+    return nullptr;
+  }
+}
+
+void pg_manifest_free(pg_manifest* m) {
+  delete m;
+}
+
+size_t pg_manifest_count(const pg_manifest* m) {
+  return m->manifest.slugs().size();
+}
+
+const char* pg_manifest_slug(const pg_manifest* m, size_t i) {
+  const auto& slugs = m->manifest.slugs();
+  return i < slugs.size() ? slugs[i].c_str() : nullptr;
+}
+
+const char* pg_manifest_field(const pg_manifest* m, const char* slug, const char* field) {
+  const polyglot::LangSpec* s = m->manifest.find(slug);
+  if (!s) return nullptr;
+  const std::string f = field;
+  if (f == "slug")           return s->slug.c_str();
+  if (f == "file")           return s->file.c_str();
+  if (f == "base_image")     return s->base_image.c_str();
+  if (f == "install_cmd")    return s->install_cmd.c_str();
+  if (f == "env_path")       return s->env_path.c_str();
+  if (f == "build_cmd")      return s->build_cmd.c_str();
+  if (f == "run_cmd")        return s->run_cmd.c_str();
+  if (f == "hello")          return s->hello.c_str();
+  if (f == "effective_file") return s->effective_file.c_str();
+  if (f == "cpu")            return s->cpu.c_str();
+  if (f == "mem")            return s->mem.c_str();
+  if (f == "width")          return s->width.c_str();
+  return nullptr;
+}
+
+int pg_render(const pg_manifest* m, const char* slug, pg_artifact_fn fn, void* ctx) {
+  const polyglot::LangSpec* s = m->manifest.find(slug);
+  if (!s) {
+    g_last_error = std::string("Unknown language: ") + slug;
+    return -1;
+  }
+  try {
+    for (const auto& a : polyglot::render(*s)) {
+      fn(ctx, a.name.c_str(), a.content.data(), a.content.size(), a.executable ? 1 : 0);
+    }
+  } catch (const std::exception& e) {
+    g_last_error = e.what();
+    return -1;
+  }
+  return 0;
+}
+
+const char* pg_last_error(void) {
+  return g_last_error.c_str();
+}
+
+}  // extern "C"
@@ -0,0 +1,35 @@
+#include "launch.hpp"
+
+#include <stdexcept>
+
+namespace polyglot {
+
+LaunchProfile LaunchProfile::lean() {
+  LaunchProfile p;
+  p.no_network = true;
+  p.no_logs = true;
+  p.read_only = true;
+  p.drop_caps = true;
+  return p;
+}
+
+LaunchProfile LaunchProfile::named(const std::string& name) {
+  if (name.empty() || name == "default") return LaunchProfile();
+  if (name == "lean") return lean();
+  throw std::runtime_error("Unknown launch profile: " + name + " (expected default or lean)");
+}
+
+std::vector<std::string> launch_args(const LaunchProfile& p) {
+  std::vector<std::string> args;
+  if (p.no_network) args.insert(args.end(), {"--network", "none"});
+  if (p.no_logs) args.insert(args.end(), {"--log-driver", "none", "-a", "stdout", "-a", "stderr"});
+  if (p.read_only) {
+    // Some toolchains still write caches at run time; give them a small scratch /tmp.
+    args.insert(args.end(), {"--read-only", "--tmpfs", "/tmp:rw,exec,size=64m", "-e", "HOME=/tmp"});
+  }
+  if (p.drop_caps) args.insert(args.end(), {"--cap-drop", "ALL", "--security-opt", "no-new-privileges"});
+  if (p.no_seccomp) args.insert(args.end(), {"--security-opt", "seccomp=unconfined"});
+  return args;
+}
+
+}  // namespace polyglot
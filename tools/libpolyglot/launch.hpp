@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace polyglot {
+
+// How run-phase containers are launched. Docker's defaults give every container a
+// network namespace and veth pair, a json-file log stream, a writable overlay upper
+// dir and the default capability set; a hello program needs none of them. The lean
+// profile turns each off. Individual switches exist so the launch benchmark can
+// price each default separately.
+struct LaunchProfile {
+  bool no_network = false;  // --network none
+  bool no_logs = false;     // --log-driver none, stdout/stderr attached directly
+  bool read_only = false;   // --read-only rootfs, tmpfs /tmp, HOME=/tmp
+  bool drop_caps = false;   // --cap-drop ALL, no-new-privileges
+  bool no_seccomp = false;  // seccomp=unconfined; benchmark only, never in a profile
+
+  static LaunchProfile lean();
+  // "default" or "lean"; throws std::runtime_error otherwise.
+  static LaunchProfile named(const std::string& name);
+};
+
+// `docker run` flags for a profile (not including --rm, platform or the image).
+std::vector<std::string> launch_args(const LaunchProfile& profile);
+
+}  // namespace polyglot
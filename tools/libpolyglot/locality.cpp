@@ -0,0 +1,78 @@
+#include "locality.hpp"
+
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace polyglot {
+
+static std::string repository(const std::string& image) {
+  const size_t slash = image.rfind('/');
+  const size_t colon = image.find(':', slash == std::string::npos ? 0 : slash);
+  return image.substr(0, colon);
+}
+
+size_t image_affinity(const ImageInfo& a, const ImageInfo& b) {
+  if (!a.layers.empty() && !b.layers.empty()) {
+    size_t n = 0;
+    while (n < a.layers.size() && n < b.layers.size() && a.layers[n] == b.layers[n]) ++n;
+    if (n > 0) return n + 2;  // any shared layer beats a name match
+  }
+  if (a.base_image == b.base_image) return 2;
+  return repository(a.base_image) == repository(b.base_image) ? 1 : 0;
+}
+
+std::vector<std::string> locality_order(const std::vector<ImageInfo>& input) {
+  std::vector<ImageInfo> images = input;
+  std::sort(images.begin(), images.end(), [](const ImageInfo& a, const ImageInfo& b) { return a.slug < b.slug; });
+
+  std::map<std::string, size_t> family;
+  for (const auto& im : images) family[im.base_image]++;
+
+  std::vector<std::string> order;
+  std::vector<bool> used(images.size(), false);
+  size_t cur = images.size();
+  for (size_t i = 0; i < images.size(); ++i) {
+    if (cur == images.size() || family[images[i].base_image] > family[images[cur].base_image]) cur = i;
+  }
+
+  while (cur < images.size()) {
+    used[cur] = true;
+    order.push_back(images[cur].slug);
+    size_t next = images.size(), best = 0;
+    for (size_t i = 0; i < images.size(); ++i) {
+      if (used[i]) continue;
+      const size_t a = image_affinity(images[cur], images[i]);
+      // Among unrelated images, fall back to the largest remaining family.
+      const bool better = next == images.size() || a > best ||
+                          (a == 0 && best == 0 && family[images[i].base_image] > family[images[next].base_image]);
+      if (better) {
+        next = i;
+        best = a;
+      }
+    }
+    cur = next;
+  }
+  return order;
+}
+
+size_t layer_transitions(const std::vector<ImageInfo>& images, const std::vector<std::string>& order) {
+  std::unordered_map<std::string, const ImageInfo*> by_slug;
+  for (const auto& im : images) by_slug[im.slug] = &im;
+
+  size_t total = 0;
+  std::unordered_set<std::string> prev;
+  for (const auto& slug : order) {
+    auto it = by_slug.find(slug);
+    if (it == by_slug.end()) continue;
+    const ImageInfo& im = *it->second;
+    std::unordered_set<std::string> now(im.layers.begin(), im.layers.end());
+    if (now.empty()) now.insert("base:" + im.base_image);
+    for (const auto& l : now) total += prev.count(l) ? 0 : 1;
+    prev = std::move(now);
+  }
+  return total;
+}
+
+}  // namespace polyglot
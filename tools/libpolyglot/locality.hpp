@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace polyglot {
+
+// What locality ordering knows about one slug's image.
+struct ImageInfo {
+  std::string slug;
+  std::string base_image;           // from the manifest, e.g. "debian:bookworm-slim"
+  std::vector<std::string> layers;  // RootFS layer digests, bottom first; empty if unknown
+};
+
+// How much two images have in common: the number of shared bottom layers when both
+// layer lists are known, else 2 for the same base image, 1 for the same repository
+// (tags differ), 0 otherwise.
+size_t image_affinity(const ImageInfo& a, const ImageInfo& b);
+
+// Orders slugs so that related images run back to back, keeping their shared layers
+// hot in the page cache. Greedy chain: start from the biggest base-image family, then
+// repeatedly take the unvisited image with the highest affinity to the last one
+// (ties alphabetical). O(n^2) in the number of slugs.
+std::vector<std::string> locality_order(const std::vector<ImageInfo>& images);
+
+// Layers the sweep has to bring in that the previous image didn't use, summed over
+// an order: a proxy for cold layer reads. Images without layer lists count as one.
+size_t layer_transitions(const std::vector<ImageInfo>& images, const std::vector<std::string>& order);
+
+}  // namespace polyglot
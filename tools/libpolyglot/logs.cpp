@@ -0,0 +1,187 @@
+#include "logs.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#include "sweep.hpp"
+#include "text.hpp"
+
+namespace fs = std::filesystem;
+
+namespace polyglot {
+
+namespace {
+
+constexpr uint32_t kZstdMagic = 0xFD2FB528;
+constexpr uint32_t kSkippableMagic = 0x184D2A5E;  // skippable frame variant used by the seekable format
+constexpr uint32_t kSeekableMagic = 0x8F92EAB1;
+constexpr size_t kMaxRawBlock = 128 * 1024;
+
+void put_le(std::string& out, uint64_t v, int bytes) {
+  for (int i = 0; i < bytes; ++i) out += (char)((v >> (8 * i)) & 0xFF);
+}
+
+uint64_t get_le(std::string_view in, size_t pos, int bytes) {
+  uint64_t v = 0;
+  for (int i = 0; i < bytes; ++i) v |= (uint64_t)(unsigned char)in[pos + i] << (8 * i);
+  return v;
+}
+
+fs::path index_path(const fs::path& dir, const std::string& sweep_id) { return dir / (sweep_id + ".idx"); }
+
+}  // namespace
+
+std::string zstd_raw_frame(std::string_view data) {
+  std::string out;
+  put_le(out, kZstdMagic, 4);
+  out += (char)0xE0;  // 8-byte content size, single segment, no checksum, no dictionary
+  put_le(out, data.size(), 8);
+  size_t pos = 0;
+  do {
+    const size_t n = std::min(kMaxRawBlock, data.size() - pos);
+    const bool last = pos + n == data.size();
+    put_le(out, (uint64_t)(n << 3) | (last ? 1 : 0), 3);  // block type 0: raw
+    out.append(data.substr(pos, n));
+    pos += n;
+  } while (pos < data.size());
+  return out;
+}
+
+bool zstd_read_raw_frame(std::string_view frame, std::string& out) {
+  if (frame.size() < 13 || get_le(frame, 0, 4) != kZstdMagic || (unsigned char)frame[4] != 0xE0) return false;
+  size_t pos = 13;
+  out.clear();
+  out.reserve(get_le(frame, 5, 8));
+  for (;;) {
+    if (pos + 3 > frame.size()) return false;
+    const uint64_t header = get_le(frame, pos, 3);
+    pos += 3;
+    const size_t n = (size_t)(header >> 3);
+    if (((header >> 1) & 3) != 0 || pos + n > frame.size()) return false;
+    out.append(frame.substr(pos, n));
+    pos += n;
+    if (header & 1) return true;
+  }
+}
+
+fs::path log_archive_path(const fs::path& dir, const std::string& sweep_id) { return dir / (sweep_id + ".zst"); }
+
+std::vector<LogRecord> read_log_index(const fs::path& dir, const std::string& sweep_id) {
+  std::vector<LogRecord> out;
+  std::ifstream in(index_path(dir, sweep_id));
+  for (std::string line; std::getline(in, line);) {
+    const auto f = split_tabs(line);
+    if (f.size() < 7) continue;
+    LogRecord r;
+    r.slug = f[0];
+    r.phase = f[1];
+    r.attempt = std::atoi(f[2].c_str());
+    r.status = std::atoi(f[3].c_str());
+    r.offset = std::strtoull(f[4].c_str(), nullptr, 10);
+    r.compressed_size = std::strtoull(f[5].c_str(), nullptr, 10);
+    r.size = std::strtoull(f[6].c_str(), nullptr, 10);
+    out.push_back(std::move(r));
+  }
+  return out;
+}
+
+std::vector<std::string> log_sweeps(const fs::path& dir) {
+  std::vector<std::string> out;
+  std::error_code ec;
+  for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+    if (it->path().extension() == ".idx") out.push_back(it->path().stem().string());
+  }
+  std::sort(out.begin(), out.end());
+  return out;
+}
+
+std::string read_log(const fs::path& dir, const std::string& sweep_id, const LogRecord& record) {
+  std::ifstream in(log_archive_path(dir, sweep_id), std::ios::binary);
+  if (!in) throw std::runtime_error("Cannot open " + log_archive_path(dir, sweep_id).string());
+  std::string frame(record.compressed_size, '\0');
+  in.seekg((std::streamoff)record.offset);
+  if (!in.read(&frame[0], (std::streamsize)frame.size())) {
+    throw std::runtime_error("Truncated log archive " + log_archive_path(dir, sweep_id).string());
+  }
+  std::string text;
+  if (zstd_read_raw_frame(frame, text)) return text;
+  PhaseResult r = spawn_phase({"zstd", "-q", "-d", "-c"}, &frame);
+  if (r.status != 0) throw std::runtime_error("zstd failed: " + trim(r.err));
+  return r.out;
+}
+
+LogArchive::LogArchive(const fs::path& dir, const std::string& sweep_id, int level)
+    : archive_(log_archive_path(dir, sweep_id)), index_(index_path(dir, sweep_id)), level_(level) {
+  fs::create_directories(dir);
+  records_ = read_log_index(dir, sweep_id);
+  for (const auto& r : records_) end_ = std::max(end_, r.offset + r.compressed_size);
+  std::sort(records_.begin(), records_.end(), [](const LogRecord& a, const LogRecord& b) { return a.offset < b.offset; });
+  std::error_code ec;
+  if (fs::exists(archive_, ec) && fs::file_size(archive_, ec) > end_) fs::resize_file(archive_, end_);  // old seek table
+  data_ = std::fopen(archive_.c_str(), "ab");
+  idx_ = std::fopen(index_.c_str(), "a");
+  if (!data_ || !idx_) {
+    close();
+    throw std::runtime_error("Cannot open log archive " + archive_.string());
+  }
+}
+
+LogArchive::~LogArchive() {
+  try {
+    close();
+  } catch (...) {
+  }
+}
+
+std::string LogArchive::compress(const std::string& text) const {
+  PhaseResult r = spawn_phase({"zstd", "-q", "-c", "-" + std::to_string(level_)}, &text);
+  if (r.status == 0 && !r.out.empty()) return r.out;
+  return zstd_raw_frame(text);
+}
+
+void LogArchive::add(const std::string& slug, const std::string& phase, int attempt, int status,
+                     const std::string& out, const std::string& err) {
+  const std::string head = "---- " + slug + " " + phase + " (attempt " + std::to_string(attempt) + ", exit " +
+                           std::to_string(status) + ") ";
+  std::string text = head + "stdout ----\n" + out;
+  if (!out.empty() && out.back() != '\n') text += '\n';
+  text += head + "stderr ----\n" + err;
+  const std::string frame = compress(text);
+
+  std::lock_guard<std::mutex> lock(mu_);
+  if (!data_) throw std::runtime_error("Log archive is closed: " + archive_.string());
+  LogRecord r{slug, phase, attempt, status, end_, frame.size(), text.size()};
+  if (std::fwrite(frame.data(), 1, frame.size(), data_) != frame.size() || std::fflush(data_) != 0) {
+    throw std::runtime_error("Cannot write " + archive_.string());
+  }
+  end_ += frame.size();
+  std::fprintf(idx_, "%s\t%s\t%d\t%d\t%llu\t%llu\t%llu\n", slug.c_str(), phase.c_str(), attempt, status,
+               (unsigned long long)r.offset, (unsigned long long)r.compressed_size, (unsigned long long)r.size);
+  std::fflush(idx_);
+  records_.push_back(std::move(r));
+}
+
+void LogArchive::close() {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (data_ && !records_.empty()) {
+    std::string table;
+    for (const auto& r : records_) {
+      put_le(table, r.compressed_size, 4);
+      put_le(table, r.size, 4);
+    }
+    put_le(table, records_.size(), 4);
+    table += '\0';  // descriptor: no checksums
+    put_le(table, kSeekableMagic, 4);
+    std::string frame;
+    put_le(frame, kSkippableMagic, 4);
+    put_le(frame, table.size(), 4);
+    frame += table;
+    std::fwrite(frame.data(), 1, frame.size(), data_);
+  }
+  if (data_) std::fclose(data_);
+  if (idx_) std::fclose(idx_);
+  data_ = idx_ = nullptr;
+}
+
+}  // namespace polyglot
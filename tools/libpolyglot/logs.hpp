@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace polyglot {
+
+// ---- per-sweep log archives ----
+//
+// Every phase attempt's stdout and stderr go into <dir>/<sweep_id>.zst as one zstd
+// frame each, appended as jobs finish, with <dir>/<sweep_id>.idx locating them:
+//   slug  phase  attempt  exit  offset  compressed_size  size
+// Fetching one log is an index lookup, one seek and one frame to decompress. When
+// the archive is closed a zstd seekable-format seek table (a skippable frame) is
+// appended, so `zstd -dc` still reads the whole file and seekable-aware tools can
+// jump to any frame. Frames are compressed with the zstd CLI; without it they are
+// stored as uncompressed (raw-block) zstd frames, which we can read back ourselves.
+
+struct LogRecord {
+  std::string slug;
+  std::string phase;
+  int attempt = 0;
+  int status = 0;
+  uint64_t offset = 0;
+  uint64_t compressed_size = 0;
+  uint64_t size = 0;
+};
+
+class LogArchive {
+ public:
+  // Opens (or continues) the archive for a sweep. Reopening drops the seek table and
+  // appends after the last indexed frame, so several writers can take turns.
+  LogArchive(const std::filesystem::path& dir, const std::string& sweep_id, int level = 3);
+  ~LogArchive();
+  LogArchive(const LogArchive&) = delete;
+  LogArchive& operator=(const LogArchive&) = delete;
+
+  // Appends one phase attempt's output. Thread-safe.
+  void add(const std::string& slug, const std::string& phase, int attempt, int status, const std::string& out,
+           const std::string& err);
+  // Writes the seek table; called by the destructor if not before.
+  void close();
+
+ private:
+  std::string compress(const std::string& text) const;
+
+  std::filesystem::path archive_;
+  std::filesystem::path index_;
+  int level_;
+  std::FILE* data_ = nullptr;
+  std::FILE* idx_ = nullptr;
+  uint64_t end_ = 0;
+  std::vector<LogRecord> records_;
+  std::mutex mu_;
+};
+
+std::filesystem::path log_archive_path(const std::filesystem::path& dir, const std::string& sweep_id);
+std::vector<LogRecord> read_log_index(const std::filesystem::path& dir, const std::string& sweep_id);
+// Sweep ids with an index in `dir`, oldest first (ids start with a UTC timestamp).
+std::vector<std::string> log_sweeps(const std::filesystem::path& dir);
+// One record's text, read and decompressed on its own.
+std::string read_log(const std::filesystem::path& dir, const std::string& sweep_id, const LogRecord& record);
+
+// A valid zstd frame holding `data` uncompressed (raw blocks), and the inverse; the
+// latter returns false for frames with compressed blocks.
+std::string zstd_raw_frame(std::string_view data);
+bool zstd_read_raw_frame(std::string_view frame, std::string& out);
+
+}  // namespace polyglot
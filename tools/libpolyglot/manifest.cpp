@@ -0,0 +1,262 @@
+#include "manifest.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "resources.hpp"
+#include "stats.hpp"
+#include "text.hpp"
+
+namespace polyglot {
+
+static bool looks_like_header(const std::vector<std::string>& cols) {
+  if (cols.empty()) return false;
+  return lower(trim(cols[0])) == "slug";
+}
+
+static void ensure_contains_pkg(std::string& install_cmd, const std::string& pkg_token) {
+  // Very light heuristic: only add if not already present.
+  if (icontains(install_cmd, pkg_token)) return;
+  // Try to insert right after "--no-install-recommends" if present.
+  auto key = std::string("--no-install-recommends");
+  auto p = install_cmd.find(key);
+  if (p != std::string::npos) {
+    p += key.size();
+    install_cmd.insert(p, " " + pkg_token);
+  } else {
+    // Otherwise just append token (works for simple one-line installs)
+    install_cmd += " " + pkg_token;
+  }
+}
+
+// Durable fixups so you don't hand-edit Dockerfiles.
+void apply_fixups(LangSpec& s) {
+  // COBOL:
+  // Your source is free-format (starts in column 1). GnuCOBOL defaults to fixed-format,
+  // which causes "invalid indicator ... at column 7". Add `-free` to cobc.
+  if (s.slug == "cobol") {
+    if (icontains(s.build_cmd, "cobc") && !icontains(s.build_cmd, "-free")) {
+      // Insert "-free" after "cobc" token.
+      // Handles: "cobc -x ..." and "cobc ...".
+      replace_all(s.build_cmd, "cobc -", "cobc -free -");
+      if (s.build_cmd.rfind("cobc ", 0) == 0 && !icontains(s.build_cmd, "cobc -free")) {
+        // If it was "cobc hello.cob ..." (no flags), just prefix.
+        replace_all(s.build_cmd, "cobc ", "cobc -free ");
+      }
+      // If still not present (weird formatting), append as last resort.
+      if (!icontains(s.build_cmd, "-free")) s.build_cmd = "cobc -free " + s.build_cmd.substr(5);
+    }
+  }
+
+  // Emojicode:
+  // Don’t splice into the user heredoc (it’s easy to break "\" continuations).
+  // Instead, normalize to Ubuntu 20.04 and replace install_cmd with a robust heredoc
+  // that installs LLVM/Clang 8 properly and builds emojicode.
+  if (s.slug == "emojicode") {
+    s.base_image = "ubuntu:20.04";
+    s.env_path   = "/usr/local/bin";
+
+    s.install_cmd =
+      "<<'EOF'\n"
+      "set -e\n"
+      "export DEBIAN_FRONTEND=noninteractive\n"
+      "apt-get update\n"
+      "\n"
+      "# Toolchain + deps\n"
+      "apt-get install -y --no-install-recommends \\\n"
+      "  ca-certificates \\\n"
+      "  build-essential \\\n"
+      "  cmake \\\n"
+      "  git \\\n"
+      "  libffi-dev \\\n"
+      "  libedit-dev \\\n"
+      "  zlib1g-dev \\\n"
+      "  clang-8 \\\n"
+      "  llvm-8 \\\n"
+      "  llvm-8-dev \\\n"
+      "  llvm-8-tools\n"
+      "\n"
+      "rm -rf /var/lib/apt/lists/*\n"
+      "\n"
+      "# Ensure v8 tools are the defaults (only if the paths exist)\n"
+      "if [ -x /usr/bin/llvm-config-8 ]; then\n"
+      "  update-alternatives --install /usr/bin/llvm-config llvm-config /usr/bin/llvm-config-8 100 || true\n"
+      "fi\n"
+      "if [ -x /usr/bin/clang-8 ]; then\n"
+      "  update-alternatives --install /usr/bin/clang clang /usr/bin/clang-8 100 || true\n"
+      "fi\n"
+      "if [ -x /usr/bin/clang++-8 ]; then\n"
+      "  update-alternatives --install /usr/bin/clang++ clang++ /usr/bin/clang++-8 100 || true\n"
+      "fi\n"
+      "\n"
+      "# Build emojicode\n"
+      "git clone --depth=1 https://github.com/emojicode/emojicode.git /tmp/emojic\n"
+      "mkdir -p /tmp/emojic/build\n"
+      "cd /tmp/emojic/build\n"
+      "\n"
+      "LLVM_DIR=\"$(llvm-config --cmakedir 2>/dev/null || true)\"\n"
+      "if [ -z \"$LLVM_DIR\" ]; then\n"
+      "  LLVM_DIR=\"$(llvm-config --prefix)/lib/cmake/llvm\"\n"
+      "fi\n"
+      "\n"
+      "cmake -DLLVM_DIR=\"$LLVM_DIR\" ..\n"
+      "make -j\"${POLYGLOT_JOBS:-$(nproc)}\"\n"
+      "make install\n"
+      "rm -rf /tmp/emojic\n"
+      "EOF";
+  }
+
+  // Julia PATH nudge
+  if (s.env_path.empty() && s.base_image.rfind("julia:", 0) == 0) {
+    s.env_path = "/usr/local/julia/bin";
+  }
+}
+
+bool ManifestParser::read_header(const std::string& first) {
+  auto first_cols = split_tabs(first);
+  if (looks_like_header(first_cols)) {
+    has_header_ = true;
+    for (size_t i = 0; i < first_cols.size(); ++i) {
+      auto key = lower(trim(first_cols[i]));
+      if (!key.empty()) h_[key] = i;
+    }
+  }
+  return has_header_;
+}
+
+bool ManifestParser::parse_row(const std::string& raw_line, LangSpec& spec) const {
+  stats::Probe probe(stats::kParseRow);
+  std::string line = raw_line;
+  if (trim(line).empty()) return false;
+  if (!trim(line).empty() && trim(line)[0] == '#') return false;
+
+  auto cols = split_tabs(line);
+
+  spec = LangSpec();
+  spec.slug       = trim(get(cols, "slug",       0));
+  spec.file       = trim(get(cols, "file",       1));
+  spec.base_image = trim(get(cols, "base_image", 2));
+
+  spec.install_cmd = trim(get(cols, "install_cmd", kNoIndex));
+  spec.env_path    = trim(get(cols, "env_path",    kNoIndex));
+
+  spec.build_cmd   = trim(get(cols, "build_cmd",   3));
+  spec.run_cmd     = trim(get(cols, "run_cmd",     4));
+  spec.hello       = get(cols, "hello",           5);
+
+  spec.cpu         = trim(get(cols, "cpu",         kNoIndex));
+  spec.mem         = trim(get(cols, "mem",         kNoIndex));
+  spec.width       = trim(get(cols, "width",       kNoIndex));
+
+  if (spec.slug.empty() || spec.file.empty() || spec.base_image.empty() || spec.run_cmd.empty()) {
+    std::cerr << "Skipping malformed line: " << line << "\n";
+    return false;
+  }
+  // Resource cells are checked here, once, so render() never sees a bad one.
+  try {
+    declared_resources(spec);
+  } catch (const std::runtime_error& e) {
+    std::cerr << "Skipping malformed line (" << e.what() << "): " << line << "\n";
+    return false;
+  }
+
+  // Unescape + strip BOMs
+  {
+    stats::Probe unescape_probe(stats::kUnescape);
+    spec.slug        = strip_utf8_bom(unescape(spec.slug));
+    spec.file        = strip_utf8_bom(unescape(spec.file));
+    spec.base_image  = strip_utf8_bom(unescape(spec.base_image));
+    spec.install_cmd = strip_utf8_bom(unescape(spec.install_cmd));
+    spec.env_path    = strip_utf8_bom(unescape(spec.env_path));
+    spec.build_cmd   = strip_utf8_bom(unescape(spec.build_cmd));
+    spec.run_cmd     = strip_utf8_bom(unescape(spec.run_cmd));
+    spec.hello       = strip_utf8_bom(unescape(spec.hello));
+  }
+
+  // Apply durable fixups
+  {
+    stats::Probe fixups_probe(stats::kFixups);
+    apply_fixups(spec);
+  }
+
+  // Determine filename to generate/copy.
+  stats::Probe resolve_probe(stats::kResolveFile);
+  std::string effective_file = normalize_filename(spec.file);
+  const std::string ext = file_ext(effective_file);
+
+  const std::string build_ref = normalize_filename(find_last_file_ref(spec.build_cmd, ext));
+  const std::string run_ref   = normalize_filename(find_last_file_ref(spec.run_cmd, ext));
+
+  if (!build_ref.empty()) effective_file = build_ref;
+  else if (!run_ref.empty()) effective_file = run_ref;
+
+  spec.effective_file = effective_file;
+  return true;
+}
+
+std::string ManifestParser::get(const std::vector<std::string>& cols,
+                                const std::string& name,
+                                size_t fallback_index) const {
+  if (has_header_) {
+    auto it = h_.find(name);
+    if (it != h_.end() && it->second < cols.size()) return cols[it->second];
+  }
+  if (fallback_index != kNoIndex && fallback_index < cols.size()) return cols[fallback_index];
+  return "";
+}
+
+std::vector<LangSpec> parse_manifest(std::istream& in) {
+  std::vector<LangSpec> specs;
+
+  std::string first;
+  if (!std::getline(in, first)) return specs;
+
+  ManifestParser parser;
+  LangSpec spec;
+  if (!parser.read_header(first) && parser.parse_row(first, spec)) specs.push_back(std::move(spec));
+
+  std::string line;
+  while (std::getline(in, line)) {
+    if (parser.parse_row(line, spec)) specs.push_back(std::move(spec));
+  }
+  return specs;
+}
+
+bool same_spec(const LangSpec& a, const LangSpec& b) {
+  return a.slug == b.slug && a.file == b.file && a.base_image == b.base_image &&
+         a.install_cmd == b.install_cmd && a.env_path == b.env_path &&
+         a.build_cmd == b.build_cmd && a.run_cmd == b.run_cmd && a.hello == b.hello &&
+         a.effective_file == b.effective_file && a.cpu == b.cpu && a.mem == b.mem &&
+         a.width == b.width;
+}
+
+Manifest::Manifest(std::vector<LangSpec> rows) : rows_(std::move(rows)) {
+  for (size_t i = 0; i < rows_.size(); ++i) {
+    if (!index_.count(rows_[i].slug)) slugs_.push_back(rows_[i].slug);
+    index_[rows_[i].slug] = i;
+  }
+}
+
+Manifest Manifest::load(const std::filesystem::path& path) {
+  std::ifstream in(path);
+  if (!in) throw std::runtime_error("Cannot open manifest: " + path.string());
+  return parse(in);
+}
+
+Manifest Manifest::parse(std::istream& in) {
+  return Manifest(parse_manifest(in));
+}
+
+Manifest Manifest::parse(const std::string& text) {
+  std::istringstream in(text);
+  return parse(in);
+}
+
+const LangSpec* Manifest::find(const std::string& slug) const {
+  auto it = index_.find(slug);
+  return it == index_.end() ? nullptr : &rows_[it->second];
+}
+
+}  // namespace polyglot
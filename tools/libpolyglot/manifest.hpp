@@ -0,0 +1,80 @@
+#pragma once
+
+#include <filesystem>
+#include <istream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace polyglot {
+
+struct LangSpec {
+  std::string slug;
+  std::string file;
+  std::string base_image;
+  std::string install_cmd;
+  std::string env_path;
+  std::string build_cmd;
+  std::string run_cmd;
+  std::string hello;
+  std::string effective_file; // resolved from file/build_cmd/run_cmd after fixups
+  std::string cpu;            // optional resource classes (see resources.hpp); "" = undeclared
+  std::string mem;
+  std::string width;          // optional parallel width (threads the job runs); "" = undeclared
+};
+
+bool same_spec(const LangSpec& a, const LangSpec& b);
+
+// Durable fixups so you don't hand-edit Dockerfiles.
+void apply_fixups(LangSpec& s);
+
+// Row parser. The header (if any) is taken from the first line; after that each
+// row parses independently, which lets --watch re-parse only lines that changed.
+class ManifestParser {
+ public:
+  // Returns true if `first` was a header row (and so is not itself a language).
+  bool read_header(const std::string& first);
+
+  // Fills spec from one row. Blank lines and comments return false silently;
+  // malformed rows are reported and return false.
+  bool parse_row(const std::string& raw_line, LangSpec& spec) const;
+
+ private:
+  static constexpr size_t kNoIndex = (size_t)-1;
+
+  std::string get(const std::vector<std::string>& cols,
+                  const std::string& name,
+                  size_t fallback_index) const;
+
+  std::unordered_map<std::string, size_t> h_;
+  bool has_header_ = false;
+};
+
+// Parses every row of the manifest, in order. Malformed rows are reported and skipped.
+// Later rows with the same slug are kept; writers process them in order, so the last wins.
+std::vector<LangSpec> parse_manifest(std::istream& in);
+
+// A parsed manifest. Immutable once built, so one instance can be queried and
+// rendered from many threads at once.
+class Manifest {
+ public:
+  static Manifest load(const std::filesystem::path& path); // throws std::runtime_error
+  static Manifest parse(std::istream& in);
+  static Manifest parse(const std::string& text);
+
+  // Every valid row in manifest order, duplicates included.
+  const std::vector<LangSpec>& rows() const { return rows_; }
+  // Unique slugs in first-seen order.
+  const std::vector<std::string>& slugs() const { return slugs_; }
+  // The row that wins for `slug` (the last one), or nullptr.
+  const LangSpec* find(const std::string& slug) const;
+
+ private:
+  explicit Manifest(std::vector<LangSpec> rows);
+
+  std::vector<LangSpec> rows_;
+  std::vector<std::string> slugs_;
+  std::unordered_map<std::string, size_t> index_;
+};
+
+}  // namespace polyglot
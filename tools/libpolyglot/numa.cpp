@@ -0,0 +1,101 @@
+#include "numa.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "text.hpp"
+#include "tree.hpp"
+
+namespace fs = std::filesystem;
+
+namespace polyglot {
+
+std::vector<int> parse_cpulist(const std::string& list) {
+  std::vector<int> out;
+  size_t i = 0;
+  auto number = [&]() {
+    const size_t start = i;
+    int n = 0;
+    while (i < list.size() && list[i] >= '0' && list[i] <= '9') n = n * 10 + (list[i++] - '0');
+    if (i == start) throw std::runtime_error("Bad cpulist: " + list);
+    return n;
+  };
+  while (i < list.size()) {
+    const int lo = number();
+    int hi = lo;
+    if (i < list.size() && list[i] == '-') {
+      ++i;
+      hi = number();
+    }
+    if (hi < lo) throw std::runtime_error("Bad cpulist: " + list);
+    for (int c = lo; c <= hi; ++c) out.push_back(c);
+    if (i < list.size() && list[i] != ',') throw std::runtime_error("Bad cpulist: " + list);
+    if (i < list.size()) ++i;
+  }
+  return out;
+}
+
+std::vector<NumaNode> numa_nodes(const fs::path& sysfs) {
+  std::vector<NumaNode> out;
+  std::error_code ec;
+  for (fs::directory_iterator it(sysfs, ec), end; !ec && it != end; it.increment(ec)) {
+    const std::string name = it->path().filename().string();
+    if (name.size() <= 4 || name.compare(0, 4, "node") != 0 ||
+        name.find_first_not_of("0123456789", 4) != std::string::npos) {
+      continue;
+    }
+    NumaNode n;
+    n.id = std::stoi(name.substr(4));
+    n.cpulist = trim(read_file_or_empty(it->path() / "cpulist"));
+    n.cpus = parse_cpulist(n.cpulist);
+    if (!n.cpus.empty()) out.push_back(std::move(n));
+  }
+  std::sort(out.begin(), out.end(), [](const NumaNode& a, const NumaNode& b) { return a.id < b.id; });
+  return out;
+}
+
+std::vector<std::string> placement_args(const Placement& placement) {
+  if (placement.node < 0) {
+    if (placement.cpus.empty()) return {};
+    return {"--cpuset-cpus", placement.cpus};
+  }
+  return {"--cpuset-cpus", placement.cpus, "--cpuset-mems", std::to_string(placement.mem_node)};
+}
+
+NodeBalancer::NodeBalancer(std::vector<NumaNode> nodes) : nodes_(std::move(nodes)), running_(nodes_.size(), 0) {}
+
+Placement NodeBalancer::acquire() {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (nodes_.empty()) return {};
+  size_t best = 0;
+  for (size_t i = 1; i < nodes_.size(); ++i) {
+    // running_[i] / cpus[i] < running_[best] / cpus[best], without division
+    if ((uint64_t)running_[i] * nodes_[best].cpus.size() < (uint64_t)running_[best] * nodes_[i].cpus.size()) best = i;
+  }
+  ++running_[best];
+  return local(nodes_[best].id);
+}
+
+void NodeBalancer::release(const Placement& placement) {
+  std::lock_guard<std::mutex> lock(mu_);
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    if (nodes_[i].id == placement.node && running_[i] > 0) --running_[i];
+  }
+}
+
+Placement NodeBalancer::local(int node) const {
+  for (const auto& n : nodes_) {
+    if (n.id == node) return {n.id, n.id, n.cpulist};
+  }
+  return {};
+}
+
+Placement NodeBalancer::remote(int node) const {
+  if (nodes_.size() < 2) return {};
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    if (nodes_[i].id == node) return {node, nodes_[(i + 1) % nodes_.size()].id, nodes_[i].cpulist};
+  }
+  return {};
+}
+
+}  // namespace polyglot
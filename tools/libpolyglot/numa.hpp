@@ -0,0 +1,64 @@
+#pragma once
+
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace polyglot {
+
+// ---- NUMA placement for run-phase containers ----
+//
+// On multi-socket hosts a container whose threads float between sockets pays remote
+// memory latency and makes timings noisy. Each job is pinned to one node instead:
+// its CPUs (--cpuset-cpus) and its memory (--cpuset-mems) together.
+
+struct NumaNode {
+  int id = 0;
+  std::string cpulist;    // as in sysfs, e.g. "0-15,32-47"
+  std::vector<int> cpus;
+};
+
+// "0-3,8,10-11" -> {0,1,2,3,8,10,11}. Throws std::runtime_error on malformed input.
+std::vector<int> parse_cpulist(const std::string& list);
+
+// Nodes with at least one online CPU, by id, from <sysfs>/node<N>/cpulist. Empty when
+// the host exposes no NUMA information (non-Linux, or sysfs not mounted).
+std::vector<NumaNode> numa_nodes(const std::filesystem::path& sysfs = "/sys/devices/system/node");
+
+// Where one job runs. node < 0 means not on a NUMA node; `cpus` may still pin it to
+// cores of its own (a parallel job's width).
+struct Placement {
+  int node = -1;       // whose CPUs the job gets
+  int mem_node = -1;   // whose memory; == node unless deliberately remote
+  std::string cpus;    // cpulist of `node`, or the job's own cores
+  unsigned width = 0;  // threads the job should run (see width_env); 0 = its own choice
+};
+
+// `docker run` cpuset flags for a placement; none when it has no CPUs.
+std::vector<std::string> placement_args(const Placement& placement);
+
+// Hands out placements to concurrent jobs, always on the node with the fewest running
+// jobs per CPU (ties to the lowest id), so load stays even across sockets. With no
+// nodes every placement is unplaced. Thread-safe.
+class NodeBalancer {
+ public:
+  explicit NodeBalancer(std::vector<NumaNode> nodes);
+
+  Placement acquire();
+  void release(const Placement& placement);
+
+  // CPUs on `node`, memory on the next node: the remote case for benchmarks. Unplaced
+  // when the host has fewer than two nodes.
+  Placement remote(int node) const;
+  Placement local(int node) const;
+
+  const std::vector<NumaNode>& nodes() const { return nodes_; }
+
+ private:
+  std::vector<NumaNode> nodes_;
+  std::vector<unsigned> running_;
+  std::mutex mu_;
+};
+
+}  // namespace polyglot
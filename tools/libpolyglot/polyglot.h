@@ -0,0 +1,45 @@
+#ifndef LIBPOLYGLOT_POLYGLOT_H
+#define LIBPOLYGLOT_POLYGLOT_H
+
+/* C ABI for libpolyglot. A pg_manifest is immutable once opened, so concurrent
+ * queries and renders on the same handle are safe. Returned strings are owned
+ * by the manifest and stay valid until pg_manifest_free. */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct pg_manifest pg_manifest;
+
+/* NULL on failure; see pg_last_error. */
+pg_manifest* pg_manifest_open(const char* path);
+pg_manifest* pg_manifest_parse(const char* text, size_t len);
+void pg_manifest_free(pg_manifest* m);
+
+/* Unique slugs, in first-seen order. */
+size_t pg_manifest_count(const pg_manifest* m);
+const char* pg_manifest_slug(const pg_manifest* m, size_t i);
+
+/* Field of the winning row for slug: "slug", "file", "base_image", "install_cmd",
+ * "env_path", "build_cmd", "run_cmd", "hello", "effective_file", "cpu", "mem" or
+ * "width" ("" when the optional cpu/mem/width columns are absent).
+ * NULL if the slug or field is unknown. */
+const char* pg_manifest_field(const pg_manifest* m, const char* slug, const char* field);
+
+/* Called once per generated file, in write order. */
+typedef void (*pg_artifact_fn)(void* ctx, const char* name, const char* content,
+                               size_t len, int executable);
+
+/* 0 on success, -1 if slug is unknown. */
+int pg_render(const pg_manifest* m, const char* slug, pg_artifact_fn fn, void* ctx);
+
+/* Message for the last failure on this thread. */
+const char* pg_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LIBPOLYGLOT_POLYGLOT_H */
@@ -0,0 +1,23 @@
+#pragma once
+
+// libpolyglot: parse languages.tsv once, then query and render it as often as needed.
+// scaffold and the polyglot dispatcher are thin CLIs over this; polyglot.h is the C ABI.
+
+#include "affected.hpp"
+#include "archive.hpp"
+#include "buildcache.hpp"
+#include "launch.hpp"
+#include "locality.hpp"
+#include "logs.hpp"
+#include "manifest.hpp"
+#include "numa.hpp"
+#include "proxy.hpp"
+#include "resources.hpp"
+#include "registry.hpp"
+#include "render.hpp"
+#include "service.hpp"
+#include "sim.hpp"
+#include "stats.hpp"
+#include "sweep.hpp"
+#include "text.hpp"
+#include "tree.hpp"
@@ -0,0 +1,640 @@
+#include "proxy.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "sweep.hpp"
+#include "text.hpp"
+#include "tree.hpp"
+
+namespace fs = std::filesystem;
+
+namespace polyglot {
+
+// ---- SHA-256 (FIPS 180-4) ----
+
+namespace {
+
+constexpr uint32_t kSha256K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+}  // namespace
+
+Sha256::Sha256()
+    : h_{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19} {}
+
+void Sha256::block(const unsigned char* p) {
+  uint32_t w[64];
+  for (int i = 0; i < 16; ++i) w[i] = (uint32_t)p[4 * i] << 24 | (uint32_t)p[4 * i + 1] << 16 | (uint32_t)p[4 * i + 2] << 8 | p[4 * i + 3];
+  for (int i = 16; i < 64; ++i) {
+    const uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    const uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+  uint32_t a = h_[0], b = h_[1], c = h_[2], d = h_[3], e = h_[4], f = h_[5], g = h_[6], h = h_[7];
+  for (int i = 0; i < 64; ++i) {
+    const uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + kSha256K[i] + w[i];
+    const uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+  h_[0] += a, h_[1] += b, h_[2] += c, h_[3] += d, h_[4] += e, h_[5] += f, h_[6] += g, h_[7] += h;
+}
+
+void Sha256::update(const void* data, size_t size) {
+  const auto* p = static_cast<const unsigned char*>(data);
+  total_ += size;
+  while (size > 0) {
+    const size_t n = std::min(size, sizeof(buf_) - used_);
+    std::memcpy(buf_ + used_, p, n);
+    used_ += n;
+    p += n;
+    size -= n;
+    if (used_ == sizeof(buf_)) {
+      block(buf_);
+      used_ = 0;
+    }
+  }
+}
+
+std::string Sha256::hex() {
+  const uint64_t bits = total_ * 8;
+  const unsigned char pad = 0x80, zero = 0;
+  update(&pad, 1);
+  while (used_ != 56) update(&zero, 1);
+  unsigned char len[8];
+  for (int i = 0; i < 8; ++i) len[i] = (unsigned char)(bits >> (56 - 8 * i));
+  update(len, 8);
+  std::string out;
+  char buf[9];
+  for (uint32_t v : h_) {
+    std::snprintf(buf, sizeof(buf), "%08x", v);
+    out += buf;
+  }
+  return out;
+}
+
+std::string sha256_hex(std::string_view data) {
+  Sha256 h;
+  h.update(data.data(), data.size());
+  return h.hex();
+}
+
+// ---- classification and stats ----
+
+namespace {
+
+bool has_prefix(const std::string& s, const char* p) { return s.compare(0, std::strlen(p), p) == 0; }
+
+bool has_suffix(const std::string& s, const char* p) {
+  const size_t n = std::strlen(p);
+  return s.size() >= n && s.compare(s.size() - n, n, p) == 0;
+}
+
+}  // namespace
+
+UrlClass classify_url(const std::string& url) {
+  std::string path = url.substr(0, url.find_first_of("?#"));
+  const size_t scheme = path.find("://");
+  if (scheme != std::string::npos) path = path.substr(std::min(path.size(), path.find('/', scheme + 3)));
+  const std::string name = path.substr(path.rfind('/') + 1);
+  if (path.find("/by-hash/") != std::string::npos || has_suffix(name, ".deb") || has_suffix(name, ".udeb") ||
+      has_suffix(name, ".ddeb") || has_suffix(name, ".apk")) {
+    return UrlClass::kPackage;
+  }
+  for (const char* p : {"InRelease", "Release", "Packages", "Sources", "Translation-", "Contents-", "APKINDEX"}) {
+    if (has_prefix(name, p)) return UrlClass::kIndex;
+  }
+  return UrlClass::kOther;
+}
+
+std::string ProxyStats::summary() const {
+  char line[256];
+  const uint64_t cacheable = hits + misses;
+  std::snprintf(line, sizeof(line),
+                "%llu hits, %llu misses (%.0f%% hit), %.1f MiB saved, %.1f MiB fetched, %llu passed through, "
+                "%llu tunnels, %llu errors",
+                (unsigned long long)hits, (unsigned long long)misses, cacheable ? 100.0 * hits / cacheable : 0.0,
+                bytes_saved / 1048576.0, bytes_fetched / 1048576.0, (unsigned long long)passthrough,
+                (unsigned long long)tunnels, (unsigned long long)errors);
+  return line;
+}
+
+// ---- the proxy ----
+
+struct PackageProxy::Reply {
+  int status = 502;
+  std::string type;
+  fs::path file;       // body; empty to send `text` instead
+  bool temp = false;   // delete `file` once sent
+  std::string text;
+  std::string location;        // of a redirect, which the client follows through us again
+  const char* cache = "MISS";  // X-Cache
+};
+
+namespace {
+
+const char* reason(int status) {
+  switch (status) {
+    case 200: return "OK";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 303: return "See Other";
+    case 307: return "Temporary Redirect";
+    case 308: return "Permanent Redirect";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 501: return "Not Implemented";
+    case 502: return "Bad Gateway";
+    case 504: return "Gateway Timeout";
+    default: return "Status";
+  }
+}
+
+bool send_all(int fd, const char* data, size_t size) {
+  while (size > 0) {
+    const ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    data += n;
+    size -= (size_t)n;
+  }
+  return true;
+}
+
+int64_t unix_now() {
+  return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// A header of the last response in a curl -D dump ("" if absent); `name` is lower case.
+std::string header_value(const std::string& headers, const std::string& name) {
+  std::string value;
+  std::istringstream in(headers);
+  for (std::string line; std::getline(in, line);) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (has_prefix(line, "HTTP/")) value.clear();
+    else if (lower(line.substr(0, name.size() + 1)) == name + ":") value = trim(line.substr(name.size() + 1));
+  }
+  return value;
+}
+
+// Loopback, link-local (cloud metadata) and unspecified addresses. The proxy listens
+// where every container on the bridge reaches it, so it must not be a way into the
+// host's own services.
+bool forbidden_address(const sockaddr* sa) {
+  if (sa->sa_family == AF_INET) {
+    const uint32_t a = ntohl(((const sockaddr_in*)sa)->sin_addr.s_addr);
+    return (a >> 24) == 127 || (a >> 16) == 0xA9FE || (a >> 24) == 0;
+  }
+  if (sa->sa_family != AF_INET6) return true;
+  const in6_addr& a = ((const sockaddr_in6*)sa)->sin6_addr;
+  if (IN6_IS_ADDR_LOOPBACK(&a) || IN6_IS_ADDR_LINKLOCAL(&a) || IN6_IS_ADDR_UNSPECIFIED(&a)) return true;
+  if (IN6_IS_ADDR_V4MAPPED(&a)) {
+    sockaddr_in v4{};
+    v4.sin_family = AF_INET;
+    std::memcpy(&v4.sin_addr, a.s6_addr + 12, 4);
+    return forbidden_address((const sockaddr*)&v4);
+  }
+  return false;
+}
+
+// Resolves host:port for an upstream connection; null (and `why`) if it doesn't resolve
+// or any of its addresses is forbidden. The caller frees the list.
+addrinfo* resolve_upstream(const std::string& host, const std::string& port, std::string& why) {
+  addrinfo hints{};
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* res = nullptr;
+  if (host.empty() || getaddrinfo(host.c_str(), port.c_str(), &hints, &res) != 0 || !res) {
+    why = "Cannot resolve " + host + "\n";
+    return nullptr;
+  }
+  for (addrinfo* a = res; a; a = a->ai_next) {
+    if (forbidden_address(a->ai_addr)) {
+      freeaddrinfo(res);
+      why = "Refusing " + host + ": loopback or link-local\n";
+      return nullptr;
+    }
+  }
+  return res;
+}
+
+// Splits "http://host[:port]/path" into host and port; false for anything else.
+bool split_http_url(const std::string& url, std::string& host, std::string& port) {
+  if (!has_prefix(url, "http://")) return false;
+  const std::string authority = url.substr(7, url.find('/', 7) - 7);
+  const size_t bracket = authority.find(']');
+  const size_t colon = authority.find(':', bracket == std::string::npos ? 0 : bracket);
+  host = authority.substr(0, colon);
+  port = colon == std::string::npos ? "80" : authority.substr(colon + 1);
+  if (host.size() > 1 && host.front() == '[' && host.back() == ']') host = host.substr(1, host.size() - 2);
+  return !host.empty();
+}
+
+}  // namespace
+
+PackageProxy::PackageProxy(ProxyOptions opts) : opts_(std::move(opts)) {
+  if (opts_.dir.empty()) throw std::runtime_error("proxy needs a cache directory");
+  fs::create_directories(opts_.dir / "blobs");
+  fs::remove_all(opts_.dir / "tmp");
+  fs::create_directories(opts_.dir / "tmp");
+  std::ifstream in(opts_.dir / "index.tsv");
+  for (std::string line; std::getline(in, line);) {
+    const auto f = split_tabs(line);
+    if (f.size() < 5) continue;
+    index_[f[0]] = {f[1], std::strtoull(f[2].c_str(), nullptr, 10), std::atoll(f[3].c_str()), f[4]};
+  }
+
+  const size_t colon = opts_.listen.rfind(':');
+  if (colon == std::string::npos) throw std::runtime_error("proxy --listen wants host:port, got " + opts_.listen);
+  const std::string host = opts_.listen.substr(0, colon), port = opts_.listen.substr(colon + 1);
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE;
+  addrinfo* res = nullptr;
+  if (getaddrinfo(host.c_str(), port.c_str(), &hints, &res) != 0 || !res) {
+    throw std::runtime_error("Cannot resolve " + opts_.listen);
+  }
+  listen_fd_ = ::socket(res->ai_family, res->ai_socktype | SOCK_CLOEXEC, res->ai_protocol);
+  const int on = 1;
+  if (listen_fd_ >= 0) ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  if (listen_fd_ < 0 || ::bind(listen_fd_, res->ai_addr, res->ai_addrlen) != 0 || ::listen(listen_fd_, 128) != 0) {
+    const std::string err = std::strerror(errno);
+    freeaddrinfo(res);
+    if (listen_fd_ >= 0) ::close(listen_fd_);
+    throw std::runtime_error("Cannot listen on " + opts_.listen + ": " + err);
+  }
+  freeaddrinfo(res);
+  sockaddr_storage bound{};
+  socklen_t len = sizeof(bound);
+  char bound_port[16] = "";
+  if (::getsockname(listen_fd_, (sockaddr*)&bound, &len) == 0) {
+    getnameinfo((sockaddr*)&bound, len, nullptr, 0, bound_port, sizeof(bound_port), NI_NUMERICSERV);
+  }
+  address_ = host + ":" + (*bound_port ? bound_port : port);
+}
+
+PackageProxy::~PackageProxy() {
+  if (listen_fd_ >= 0) ::close(listen_fd_);
+}
+
+ProxyStats PackageProxy::stats() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  return stats_;
+}
+
+void PackageProxy::serve(const std::atomic<bool>& stop) {
+  while (!stop) {
+    pollfd p{listen_fd_, POLLIN, 0};
+    if (::poll(&p, 1, 200) <= 0) continue;
+    const int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) continue;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      clients_.insert(fd);
+    }
+    std::thread([this, fd] {
+      connection(fd);
+      std::lock_guard<std::mutex> lock(mu_);
+      ::close(fd);
+      clients_.erase(fd);
+      changed_.notify_all();
+    }).detach();
+  }
+  // Wake every connection; each closes its own socket. Fetches in progress finish first.
+  std::unique_lock<std::mutex> lock(mu_);
+  for (int fd : clients_) ::shutdown(fd, SHUT_RDWR);
+  changed_.wait(lock, [this] { return clients_.empty(); });
+}
+
+void PackageProxy::connection(int fd) {
+  std::string buf;
+  char chunk[16384];
+  for (;;) {
+    size_t end;
+    while ((end = buf.find("\r\n\r\n")) == std::string::npos) {
+      if (buf.size() > (64u << 10)) return;
+      const ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) return;
+      buf.append(chunk, (size_t)n);
+    }
+    std::istringstream head(buf.substr(0, end));
+    buf.erase(0, end + 4);
+    std::string request_line, method, target, version, host;
+    std::getline(head, request_line);
+    std::istringstream(request_line) >> method >> target >> version;
+    bool keep_alive = version == "HTTP/1.1";
+    size_t body = 0;
+    for (std::string line; std::getline(head, line);) {
+      if (!line.empty() && line.back() == '\r') line.pop_back();
+      const size_t colon = line.find(':');
+      if (colon == std::string::npos) continue;
+      const std::string key = lower(trim(line.substr(0, colon))), value = trim(line.substr(colon + 1));
+      if (key == "host") host = value;
+      else if (key == "content-length") body = std::strtoull(value.c_str(), nullptr, 10);
+      else if (key == "connection" || key == "proxy-connection") keep_alive = lower(value) != "close";
+    }
+    // Request bodies (nothing apt or apk sends) are read and dropped.
+    while (buf.size() < body) {
+      const ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+      if (n <= 0) return;
+      buf.append(chunk, (size_t)n);
+    }
+    buf.erase(0, body);
+
+    if (method == "CONNECT") {
+      if (!buf.empty()) return;  // nothing may follow CONNECT before the tunnel is up
+      tunnel(fd, target);
+      return;
+    }
+    std::string url = target;
+    if (has_prefix(target, "/")) url = "http://" + host + target;
+    if (target == "/_polyglot/stats") {
+      Reply r;
+      r.status = 200;
+      r.type = "text/plain";
+      r.text = stats().summary() + "\n";
+      r.cache = "-";
+      if (!send_reply(fd, r, false, keep_alive)) return;
+    } else if (!handle(fd, method, url, method == "HEAD") || !keep_alive) {
+      return;
+    }
+    if (!keep_alive) return;
+  }
+}
+
+bool PackageProxy::lookup(const std::string& url, Entry& out) const {
+  const auto it = index_.find(url);
+  if (it == index_.end()) return false;
+  std::error_code ec;
+  if (!fs::exists(blob(it->second.sha), ec)) return false;
+  out = it->second;
+  return true;
+}
+
+PackageProxy::Reply PackageProxy::fetch(const std::string& url, bool store) {
+  Reply r;
+  fs::path tmp;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    tmp = opts_.dir / "tmp" / std::to_string(++tmp_seq_);
+  }
+  // curl connects only to the address checked here (--resolve pins it) and doesn't
+  // follow redirects itself: they go back to the client, whose next request through
+  // the proxy is checked again.
+  std::string host, port, why;
+  addrinfo* res_addr = nullptr;
+  if (!split_http_url(url, host, port)) why = "Only http:// URLs\n";
+  else res_addr = resolve_upstream(host, port, why);
+  if (!res_addr) {
+    r.status = 403;
+    r.text = why;
+    r.cache = "DENY";
+    std::lock_guard<std::mutex> lock(mu_);
+    stats_.errors++;
+    return r;
+  }
+  char numeric[NI_MAXHOST];
+  const bool v6 = res_addr->ai_family == AF_INET6;
+  const int gai = getnameinfo(res_addr->ai_addr, res_addr->ai_addrlen, numeric, sizeof(numeric), nullptr, 0,
+                              NI_NUMERICHOST);
+  freeaddrinfo(res_addr);
+  if (gai != 0) {
+    r.text = "Cannot resolve " + host + "\n";
+    return r;
+  }
+  const std::string pinned = host + ":" + port + ":" + (v6 ? "[" + std::string(numeric) + "]" : numeric);
+
+  const fs::path headers = tmp.string() + ".h";
+  PhaseResult res = spawn_phase({"curl", "-sS", "--proto", "=http", "--noproxy", "*", "--resolve", pinned,
+                                 "--max-time", "300", "-o", tmp.string(), "-D", headers.string(), "-w",
+                                 "%{http_code}", url},
+                                nullptr);
+  std::error_code ec;
+  const std::string dump = read_file_or_empty(headers);
+  r.type = header_value(dump, "content-type");
+  if (r.type.empty()) r.type = "application/octet-stream";
+  r.location = header_value(dump, "location");
+  fs::remove(headers, ec);
+  if (res.status != 0) {
+    fs::remove(tmp, ec);
+    r.status = 502;
+    r.text = "curl: " + trim(res.err) + "\n";
+    return r;
+  }
+  r.status = std::atoi(res.out.c_str());
+  r.file = tmp;
+  r.temp = true;
+  if (r.status != 200 || !store) return r;
+
+  Sha256 sha;
+  {
+    std::ifstream in(tmp, std::ios::binary);
+    char buf[65536];
+    while (in.read(buf, sizeof(buf)) || in.gcount() > 0) sha.update(buf, (size_t)in.gcount());
+  }
+  Entry e;
+  e.sha = sha.hex();
+  e.size = fs::file_size(tmp, ec);
+  e.fetched = unix_now();
+  e.type = r.type;
+  if (fs::exists(blob(e.sha), ec)) fs::remove(tmp, ec);  // same bytes under another URL
+  else fs::rename(tmp, blob(e.sha));
+  std::lock_guard<std::mutex> lock(mu_);
+  index_[url] = e;
+  std::ofstream(opts_.dir / "index.tsv", std::ios::app)
+      << url << "\t" << e.sha << "\t" << e.size << "\t" << e.fetched << "\t" << e.type << "\n";
+  r.file = blob(e.sha);
+  r.temp = false;
+  return r;
+}
+
+bool PackageProxy::handle(int fd, const std::string& method, const std::string& url, bool head) {
+  Reply r;
+  if (method != "GET" && method != "HEAD") {
+    r.status = 501;
+    r.text = "Only GET, HEAD and CONNECT\n";
+    return send_reply(fd, r, head, true);
+  }
+  const UrlClass cls = classify_url(url);
+  if (cls == UrlClass::kOther) {
+    if (opts_.offline) {
+      r.status = 504;
+      r.text = "Offline: " + url + " is not cacheable\n";
+      std::lock_guard<std::mutex> lock(mu_);
+      stats_.errors++;
+    } else {
+      r = fetch(url, false);
+      if (std::strcmp(r.cache, "DENY") != 0) {
+        r.cache = "PASS";
+        std::lock_guard<std::mutex> lock(mu_);
+        stats_.passthrough++;
+      }
+    }
+    return send_reply(fd, r, head, true);
+  }
+
+  Entry e;
+  bool have;
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    changed_.wait(lock, [&] { return !inflight_.count(url); });
+    have = lookup(url, e);
+    const bool fresh =
+        have && (cls == UrlClass::kPackage || opts_.offline || unix_now() - e.fetched < opts_.index_ttl_s);
+    if (fresh || (opts_.offline && !have)) {
+      if (fresh) {
+        stats_.hits++;
+        stats_.bytes_saved += e.size;
+        r.status = 200;
+        r.type = e.type;
+        r.file = blob(e.sha);
+        r.cache = "HIT";
+      } else {
+        stats_.errors++;
+        r.status = 504;
+        r.text = "Offline: " + url + " was never fetched\n";
+      }
+      lock.unlock();
+      return send_reply(fd, r, head, true);
+    }
+    inflight_.insert(url);
+  }
+  r = fetch(url, true);
+  std::unique_lock<std::mutex> lock(mu_);
+  inflight_.erase(url);
+  changed_.notify_all();
+  if (r.status == 200) {
+    stats_.misses++;
+    std::error_code ec;
+    stats_.bytes_fetched += fs::file_size(r.file, ec);
+  } else if (have && (r.status >= 500 || r.status == 0)) {
+    // Mirror unreachable: an old index beats a failed build.
+    std::error_code ec;
+    if (r.temp) fs::remove(r.file, ec);
+    r = Reply{};
+    r.status = 200;
+    r.type = e.type;
+    r.file = blob(e.sha);
+    r.cache = "STALE";
+    stats_.hits++;
+    stats_.bytes_saved += e.size;
+  } else if (r.status >= 500) {
+    stats_.errors++;
+  }
+  lock.unlock();
+  return send_reply(fd, r, head, true);
+}
+
+bool PackageProxy::send_reply(int fd, const Reply& r, bool head, bool keep_alive) {
+  std::error_code ec;
+  const uint64_t size = r.file.empty() ? r.text.size() : fs::file_size(r.file, ec);
+  char header[512];
+  const int n = std::snprintf(header, sizeof(header),
+                              "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %llu\r\nX-Cache: %s\r\n"
+                              "Connection: %s\r\n",
+                              r.status, reason(r.status), r.type.empty() ? "text/plain" : r.type.c_str(),
+                              (unsigned long long)size, r.cache, keep_alive ? "keep-alive" : "close");
+  std::string head_text(header, (size_t)n);
+  if (!r.location.empty() && r.location.find_first_of("\r\n") == std::string::npos) {
+    head_text += "Location: " + r.location + "\r\n";
+  }
+  head_text += "\r\n";
+  bool ok = send_all(fd, head_text.data(), head_text.size());
+  if (ok && !head) {
+    if (r.file.empty()) {
+      ok = send_all(fd, r.text.data(), r.text.size());
+    } else {
+      std::ifstream in(r.file, std::ios::binary);
+      char buf[65536];
+      while (ok && (in.read(buf, sizeof(buf)) || in.gcount() > 0)) ok = send_all(fd, buf, (size_t)in.gcount());
+    }
+  }
+  if (r.temp) fs::remove(r.file, ec);
+  return ok;
+}
+
+void PackageProxy::tunnel(int fd, const std::string& authority) {
+  // Only TLS to the mirrors: port 443, and never to the host's own addresses.
+  const size_t colon = authority.rfind(':');
+  std::string host = authority.substr(0, colon), port = colon == std::string::npos ? "443" : authority.substr(colon + 1);
+  if (host.size() > 1 && host.front() == '[' && host.back() == ']') host = host.substr(1, host.size() - 2);
+  std::string why = opts_.offline ? "Offline: no tunnels\n" : "Tunnels only to port 443\n";
+  addrinfo* res = !opts_.offline && port == "443" ? resolve_upstream(host, port, why) : nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (res) stats_.tunnels++;
+    else stats_.errors++;
+  }
+  Reply refuse;
+  refuse.cache = "-";
+  if (!res) {
+    refuse.status = 403;
+    refuse.text = why;
+    send_reply(fd, refuse, false, false);
+    return;
+  }
+  int up = -1;
+  for (addrinfo* a = res; a && up < 0; a = a->ai_next) {
+    up = ::socket(a->ai_family, a->ai_socktype | SOCK_CLOEXEC, a->ai_protocol);
+    if (up >= 0 && ::connect(up, a->ai_addr, a->ai_addrlen) != 0) {
+      ::close(up);
+      up = -1;
+    }
+  }
+  freeaddrinfo(res);
+  if (up < 0) {
+    refuse.status = 502;
+    refuse.text = "Cannot reach " + authority + "\n";
+    send_reply(fd, refuse, false, false);
+    return;
+  }
+  const char ok[] = "HTTP/1.1 200 Connection established\r\n\r\n";
+  if (send_all(fd, ok, sizeof(ok) - 1)) {
+    pollfd p[2] = {{fd, POLLIN, 0}, {up, POLLIN, 0}};
+    char buf[16384];
+    for (bool open = true; open && ::poll(p, 2, -1) > 0;) {
+      for (int i = 0; i < 2 && open; ++i) {
+        if (!(p[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+        const ssize_t n = ::recv(p[i].fd, buf, sizeof(buf), 0);
+        open = n > 0 && send_all(p[1 - i].fd, buf, (size_t)n);
+      }
+    }
+  }
+  ::close(up);
+}
+
+}  // namespace polyglot
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+
+namespace polyglot {
+
+// ---- package download cache ----
+//
+// Most debian and alpine rows download the same package indices and packages. The
+// runner starts `polyglot proxy` on localhost and points every build at it through
+// the predefined http_proxy build args (which never enter BuildKit's cache key). The
+// proxy stores what it fetches content-addressed under <dir>/blobs/<sha256>, indexed
+// by URL in <dir>/index.tsv, and serves repeats from disk:
+//   packages (.deb, .udeb, .apk, and apt's by-hash/ paths) are immutable: cached forever
+//   indices (InRelease, Release*, Packages*, Sources*, APKINDEX*) are revalidated after
+//     index_ttl, and served stale if the mirror can't be reached
+//   anything else is passed through uncached
+// Offline mode never contacts a mirror: stored files are served whatever their age,
+// everything else gets 504, so a sweep can be replayed without network. Upstream
+// fetches go through the curl CLI. HTTPS can only be tunnelled (CONNECT), not cached,
+// so only plain-http mirrors benefit.
+// The proxy is reachable from every container on the bridge and unauthenticated, so
+// it never connects to loopback, link-local or unspecified addresses (checked on the
+// resolved address, which curl is then pinned to). CONNECT goes to port 443 only.
+// Redirects are relayed to the client rather than followed, so each hop is checked.
+
+enum class UrlClass { kPackage, kIndex, kOther };
+UrlClass classify_url(const std::string& url);
+
+struct ProxyOptions {
+  std::string listen = "127.0.0.1:3142";  // port 0 picks a free one
+  std::filesystem::path dir;
+  bool offline = false;
+  int index_ttl_s = 600;
+};
+
+struct ProxyStats {
+  uint64_t hits = 0;          // served from disk
+  uint64_t misses = 0;        // fetched and stored
+  uint64_t bytes_saved = 0;   // bytes served from disk
+  uint64_t bytes_fetched = 0;
+  uint64_t passthrough = 0;   // uncacheable requests forwarded
+  uint64_t tunnels = 0;       // CONNECT
+  uint64_t errors = 0;        // upstream unreachable, or offline misses
+
+  // "412 hits, 37 misses (92% hit), 180.3 MiB saved, 12.1 MiB fetched, ..."
+  std::string summary() const;
+};
+
+// SHA-256, for content addressing.
+class Sha256 {
+ public:
+  Sha256();
+  void update(const void* data, size_t size);
+  std::string hex();  // finishes the hash
+
+ private:
+  void block(const unsigned char* p);
+
+  uint32_t h_[8];
+  unsigned char buf_[64];
+  size_t used_ = 0;
+  uint64_t total_ = 0;
+};
+std::string sha256_hex(std::string_view data);
+
+class PackageProxy {
+ public:
+  // Binds the listening socket and loads the index; throws std::runtime_error.
+  explicit PackageProxy(ProxyOptions opts);
+  ~PackageProxy();
+  PackageProxy(const PackageProxy&) = delete;
+  PackageProxy& operator=(const PackageProxy&) = delete;
+
+  // "127.0.0.1:3142", with the port actually bound.
+  std::string address() const { return address_; }
+
+  // Accepts connections (a thread each, keep-alive and pipelining supported) until
+  // `stop` is set, then closes them all and returns.
+  void serve(const std::atomic<bool>& stop);
+
+  ProxyStats stats() const;
+
+ private:
+  struct Entry {
+    std::string sha;
+    uint64_t size = 0;
+    int64_t fetched = 0;  // unix seconds
+    std::string type;     // Content-Type
+  };
+  struct Reply;
+
+  void connection(int fd);
+  bool handle(int fd, const std::string& method, const std::string& url, bool head);
+  void tunnel(int fd, const std::string& authority);
+  Reply fetch(const std::string& url, bool store);
+  static bool send_reply(int fd, const Reply& r, bool head, bool keep_alive);
+  bool lookup(const std::string& url, Entry& out) const;
+  std::filesystem::path blob(const std::string& sha) const { return opts_.dir / "blobs" / sha; }
+
+  ProxyOptions opts_;
+  int listen_fd_ = -1;
+  std::string address_;
+
+  mutable std::mutex mu_;
+  std::condition_variable changed_;
+  std::map<std::string, Entry> index_;
+  std::set<std::string> inflight_;  // URLs being fetched; others wait instead of fetching too
+  std::set<int> clients_;
+  ProxyStats stats_;
+  uint64_t tmp_seq_ = 0;
+};
+
+}  // namespace polyglot
@@ -0,0 +1,202 @@
+#include "registry.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+namespace polyglot {
+
+const char* const kRegistryHeader = "tools/libpolyglot/registry.gen.hpp";
+
+LangSpec to_lang_spec(const RegistryEntry& e) {
+  LangSpec s;
+  s.slug = std::string(e.slug);
+  s.file = std::string(e.file);
+  s.base_image = std::string(e.base_image);
+  s.install_cmd = std::string(e.install_cmd);
+  s.env_path = std::string(e.env_path);
+  s.build_cmd = std::string(e.build_cmd);
+  s.run_cmd = std::string(e.run_cmd);
+  s.hello = std::string(e.hello);
+  s.effective_file = std::string(e.effective_file);
+  s.cpu = std::string(e.cpu);
+  s.mem = std::string(e.mem);
+  s.width = std::string(e.width);
+  return s;
+}
+
+// C++ string literal; everything outside printable ASCII becomes an octal escape
+// (always three digits, so a following digit can't be absorbed).
+static std::string cpp_quote(const std::string& s) {
+  std::string out = "\"";
+  for (unsigned char c : s) {
+    switch (c) {
+      case '\\': out += "\\\\"; break;
+      case '"':  out += "\\\""; break;
+      case '\n': out += "\\n"; break;
+      case '\t': out += "\\t"; break;
+      case '\r': out += "\\r"; break;
+      default:
+        if (c < 0x20 || c >= 0x7f) {
+          char buf[5];
+          std::snprintf(buf, sizeof(buf), "\\%03o", c);
+          out += buf;
+        } else {
+          out.push_back((char)c);
+        }
+    }
+  }
+  out += "\"";
+  return out;
+}
+
+struct PerfectHash {
+  std::vector<uint32_t> seeds;  // per bucket
+  std::vector<uint16_t> slots;  // slot -> key index
+};
+
+// Hash-and-displace: place the fullest buckets first, trying seeds until every key
+// in the bucket lands on a distinct free slot. With ~4 keys per bucket and a table
+// exactly the size of the key set this settles in well under a millisecond for
+// manifests our size; if a bucket can't be placed the table grows by one and we retry.
+static PerfectHash build_perfect_hash(const std::vector<std::string>& keys) {
+  constexpr uint16_t kEmpty = 0xFFFF;
+  constexpr uint32_t kMaxSeed = 1u << 20;
+  if (keys.size() >= kEmpty) throw std::runtime_error("Too many languages for the embedded registry");
+
+  const size_t buckets = std::max<size_t>(1, (keys.size() + 3) / 4);
+  std::vector<std::vector<size_t>> members(buckets);
+  for (size_t i = 0; i < keys.size(); ++i) members[registry_hash(0, keys[i]) % buckets].push_back(i);
+
+  std::vector<size_t> order(buckets);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t a, size_t b) { return members[a].size() > members[b].size(); });
+
+  for (size_t table = std::max<size_t>(1, keys.size());; ++table) {
+    PerfectHash ph;
+    ph.seeds.assign(buckets, 0);
+    ph.slots.assign(table, kEmpty);
+    bool placed_all = true;
+
+    for (size_t b : order) {
+      if (members[b].empty()) continue;
+      bool placed = false;
+      std::vector<size_t> want;
+      for (uint32_t seed = 1; seed < kMaxSeed && !placed; ++seed) {
+        want.clear();
+        for (size_t k : members[b]) {
+          const size_t slot = registry_hash(seed, keys[k]) % table;
+          if (ph.slots[slot] != kEmpty || std::find(want.begin(), want.end(), slot) != want.end()) break;
+          want.push_back(slot);
+        }
+        if (want.size() != members[b].size()) continue;
+        for (size_t j = 0; j < want.size(); ++j) ph.slots[want[j]] = (uint16_t)members[b][j];
+        ph.seeds[b] = seed;
+        placed = true;
+      }
+      if (!placed) {
+        placed_all = false;
+        break;
+      }
+    }
+    if (placed_all) return ph;
+  }
+}
+
+template <typename T>
+static void emit_array(std::ostream& out, const char* type, const char* name, const std::vector<T>& v) {
+  out << "inline constexpr std::array<" << type << ", " << v.size() << "> " << name << " = {{";
+  for (size_t i = 0; i < v.size(); ++i) {
+    out << (i % 12 == 0 ? "\n  " : " ") << v[i] << (i + 1 < v.size() ? "," : "");
+  }
+  out << "\n}};\n";
+}
+
+std::string emit_registry(const Manifest& manifest, uint64_t manifest_hash) {
+  const auto& slugs = manifest.slugs();
+  const PerfectHash ph = build_perfect_hash(slugs);
+
+  std::ostringstream out;
+  out << "// Generated by scaffold from languages.tsv; do not edit.\n"
+         "// Build polyglot with -DPOLYGLOT_EMBEDDED_REGISTRY to use it.\n"
+         "#pragma once\n\n"
+         "#include <array>\n\n"
+         "#include \"registry.hpp\"\n\n"
+         "namespace polyglot::embedded {\n\n";
+
+  char hash[32];
+  std::snprintf(hash, sizeof(hash), "0x%016llxull", (unsigned long long)manifest_hash);
+  out << "inline constexpr uint64_t kManifestHash = " << hash << ";\n\n";
+
+  out << "inline constexpr std::array<RegistryEntry, " << slugs.size() << "> kEntries = {{\n";
+  for (const auto& slug : slugs) {
+    const LangSpec& s = *manifest.find(slug);
+    out << "  {" << cpp_quote(s.slug) << ", " << cpp_quote(s.file) << ", " << cpp_quote(s.base_image)
+        << ",\n   " << cpp_quote(s.install_cmd) << ",\n   " << cpp_quote(s.env_path)
+        << ",\n   " << cpp_quote(s.build_cmd) << ",\n   " << cpp_quote(s.run_cmd)
+        << ",\n   " << cpp_quote(s.hello) << ",\n   " << cpp_quote(s.effective_file) << ", " << cpp_quote(s.cpu)
+        << ", " << cpp_quote(s.mem) << ", " << cpp_quote(s.width) << "},\n";
+  }
+  out << "}};\n\n";
+
+  emit_array(out, "uint32_t", "kSeeds", ph.seeds);
+  emit_array(out, "uint16_t", "kSlots", ph.slots);
+
+  out << "\ninline constexpr Registry kRegistry = {\n"
+         "  kEntries.data(), kEntries.size(),\n"
+         "  kSeeds.data(), kSeeds.size(),\n"
+         "  kSlots.data(), kSlots.size(),\n"
+         "  kManifestHash,\n"
+         "};\n\n"
+         "static_assert(kRegistry.self_check(), \"embedded registry: perfect hash misses a slug\");\n\n"
+         "}  // namespace polyglot::embedded\n";
+  return out.str();
+}
+
+std::vector<std::string> verify_registry(const Registry& registry, const Manifest& manifest) {
+  std::vector<std::string> problems;
+  const auto& slugs = manifest.slugs();
+
+  for (const auto& slug : slugs) {
+    if (!registry.find(slug)) problems.push_back(slug + ": missing from embedded registry");
+  }
+  for (size_t i = 0; i < registry.count; ++i) {
+    const std::string slug(registry.entries[i].slug);
+    if (!manifest.find(slug)) problems.push_back(slug + ": in embedded registry but not in manifest");
+  }
+  if (!problems.empty()) return problems;
+
+  for (size_t i = 0; i < slugs.size(); ++i) {
+    const RegistryEntry& e = registry.entries[i];
+    if (e.slug != slugs[i]) {
+      problems.push_back("order differs at row " + std::to_string(i + 1) + ": " + std::string(e.slug) +
+                         " vs " + slugs[i]);
+      break;
+    }
+  }
+
+  for (const auto& slug : slugs) {
+    const LangSpec& want = *manifest.find(slug);
+    const LangSpec got = to_lang_spec(*registry.find(slug));
+    auto field = [&](const char* name, const std::string& a, const std::string& b) {
+      if (a != b) problems.push_back(slug + ": " + name + " differs");
+    };
+    field("file", got.file, want.file);
+    field("base_image", got.base_image, want.base_image);
+    field("install_cmd", got.install_cmd, want.install_cmd);
+    field("env_path", got.env_path, want.env_path);
+    field("build_cmd", got.build_cmd, want.build_cmd);
+    field("run_cmd", got.run_cmd, want.run_cmd);
+    field("hello", got.hello, want.hello);
+    field("effective_file", got.effective_file, want.effective_file);
+    field("cpu", got.cpu, want.cpu);
+    field("mem", got.mem, want.mem);
+    field("width", got.width, want.width);
+  }
+  return problems;
+}
+
+}  // namespace polyglot
@@ -0,0 +1,677 @@
+// Generated by scaffold from languages.tsv; do not edit.
+// Build polyglot with -DPOLYGLOT_EMBEDDED_REGISTRY to use it.
+#pragma once
+
+#include <array>
+
+#include "registry.hpp"
+
+namespace polyglot::embedded {
+
+inline constexpr uint64_t kManifestHash = 0xc6d29a70fa83bb1full;
+
+inline constexpr std::array<RegistryEntry, 91> kEntries = {{
+  {"node", "hello.js", "node:20-alpine",
+   "",
+   "",
+   "",
+   "node hello.js",
+   "console.log(\"Hello, world!\");",
+   "hello.js", "", "", ""},
+  {"ruby", "hello.rb", "ruby:3.3-alpine",
+   "",
+   "",
+   "",
+   "ruby hello.rb",
+   "puts \"Hello, world!\"",
+   "hello.rb", "", "", ""},
+  {"julia", "hello.jl", "julia:1.10",
+   "",
+   "/usr/local/julia/bin",
+   "",
+   "julia hello.jl",
+   "println(\"Hello, world!\")",
+   "hello.jl", "", "", ""},
+  {"lua", "hello.lua", "alpine:3.20",
+   "apk add --no-cache lua5.4",
+   "",
+   "",
+   "lua5.4 hello.lua",
+   "print(\"Hello, world!\")",
+   "hello.lua", "", "", ""},
+  {"go", "hello.go", "golang:1.23-alpine",
+   "",
+   "",
+   "go build -o hello hello.go",
+   "./hello",
+   "package main; import \"fmt\"; func main(){ fmt.Println(\"Hello, world!\") }",
+   "hello.go", "", "", ""},
+  {"rust", "hello.rs", "rust:1.76",
+   "",
+   "",
+   "rustc hello.rs -O",
+   "./hello",
+   "fn main(){ println!(\"Hello, world!\"); }",
+   "hello.rs", "", "", "2"},
+  {"c", "hello.c", "alpine:3.20",
+   "apk add --no-cache build-base",
+   "",
+   "cc -O2 -o hello hello.c",
+   "./hello",
+   "#include <stdio.h>\nint main(){ puts(\"Hello, world!\"); return 0; }",
+   "hello.c", "", "", ""},
+  {"java", "Hello.java", "alpine:3.20",
+   "apk add --no-cache openjdk17-jdk",
+   "",
+   "javac Hello.java",
+   "java Hello",
+   "public class Hello { public static void main(String[] args){ System.out.println(\"Hello, world!\"); } }",
+   "Hello.java", "", "", ""},
+  {"php", "hello.php", "php:8.3-cli-alpine",
+   "",
+   "",
+   "",
+   "php hello.php",
+   "<?php echo \"Hello, world!\"; ?>",
+   "hello.php", "", "", ""},
+  {"perl", "hello.pl", "alpine:3.20",
+   "apk add --no-cache perl",
+   "",
+   "",
+   "perl hello.pl",
+   "print \"Hello, world!\";",
+   "hello.pl", "", "", ""},
+  {"python", "hello.py", "python:3.12-alpine",
+   "",
+   "",
+   "",
+   "python hello.py",
+   "print(\"Hello, world!\")",
+   "hello.py", "", "", ""},
+  {"r", "hello.R", "r-base:latest",
+   "",
+   "",
+   "",
+   "Rscript hello.R",
+   "cat(\"Hello, world!\n\")",
+   "hello.R", "", "", ""},
+  {"swift", "hello.swift", "swift:latest",
+   "",
+   "",
+   "",
+   "swift hello.swift",
+   "print(\"Hello, world!\")",
+   "hello.swift", "", "", ""},
+  {"tcl", "hello.tcl", "alpine:3.20",
+   "apk add --no-cache tcl",
+   "",
+   "",
+   "tclsh hello.tcl",
+   "puts \"Hello, world!\"",
+   "hello.tcl", "", "", ""},
+  {"awk", "hello.awk", "alpine:3.20",
+   "",
+   "",
+   "",
+   "awk -f hello.awk",
+   "BEGIN { print \"Hello, world!\" }",
+   "hello.awk", "", "", ""},
+  {"basic", "hello.bas", "alpine:3.20",
+   "apk add --no-cache yabasic",
+   "",
+   "",
+   "yabasic hello.bas",
+   "print \"Hello, world!\"",
+   "hello.bas", "", "", ""},
+  {"common_lisp", "hello.lisp", "alpine:3.20",
+   "apk add --no-cache sbcl",
+   "",
+   "",
+   "sbcl --script hello.lisp",
+   "(format t \"Hello, world!~%\")",
+   "hello.lisp", "", "", ""},
+  {"cpp", "hello.cpp", "alpine:3.20",
+   "apk add --no-cache g++",
+   "",
+   "g++ -O2 -o hello hello.cpp",
+   "./hello",
+   "#include <iostream>\nint main(){ std::cout << \"Hello, world!\" << std::endl; return 0; }",
+   "hello.cpp", "", "", ""},
+  {"prolog", "hello.pl", "swipl:latest",
+   "",
+   "",
+   "",
+   "swipl -q -f hello.pl -t main -g halt",
+   ":- initialization(main).\nmain :- writeln('Hello, world!').",
+   "hello.pl", "", "", ""},
+  {"brainfuck", "hello.bf", "alpine:3.20",
+   "<<'EOF'\nset -e\napk add --no-cache build-base\ncat > /tmp/bf.c <<'C'\n#include <stdio.h>\n#include <stdlib.h>\n#include <string.h>\n\nstatic int isop(char c){\n  return c=='>'||c=='<'||c=='+'||c=='-'||c=='.'||c==','||c=='['||c==']';\n}\n\nint main(int argc, char** argv){\n  if(argc < 2){ fprintf(stderr,\"usage: bf <file>\\n\"); return 2; }\n  FILE* f = fopen(argv[1], \"rb\");\n  if(!f){ perror(argv[1]); return 1; }\n  fseek(f, 0, SEEK_END);\n  long n = ftell(f);\n  fseek(f, 0, SEEK_SET);\n  char* src = (char*)malloc((size_t)n + 1);\n  if(!src){ fclose(f); return 1; }\n  if(fread(src, 1, (size_t)n, f) != (size_t)n){ fclose(f); free(src); return 1; }\n  fclose(f);\n  src[n] = 0;\n\n  char* prog = (char*)malloc((size_t)n + 1);\n  if(!prog){ free(src); return 1; }\n  int m = 0;\n  for(long i=0;i<n;i++) if(isop(src[i])) prog[m++] = src[i];\n  prog[m] = 0;\n  free(src);\n\n  int* match = (int*)malloc(sizeof(int) * (size_t)m);\n  int* stack = (int*)malloc(sizeof(int) * (size_t)m);\n  if(!match || !stack){ free(prog); free(match); free(stack); return 1; }\n  int sp = 0;\n  for(int i=0;i<m;i++){\n    if(prog[i] == '[') stack[sp++] = i;\n    else if(prog[i] == ']'){\n      if(sp == 0){ fprintf(stderr,\"unmatched ]\\n\"); return 1; }\n      int j = stack[--sp];\n      match[i] = j;\n      match[j] = i;\n    }\n  }\n  if(sp != 0){ fprintf(stderr,\"unmatched [\\n\"); return 1; }\n\n  unsigned char tape[30000];\n  memset(tape, 0, sizeof(tape));\n  int p = 0;\n  for(int ip=0; ip<m; ip++){\n    switch(prog[ip]){\n      case '>': p = (p + 1) % 30000; break;\n      case '<': p = (p + 29999) % 30000; break;\n      case '+': tape[p]++; break;\n      case '-': tape[p]--; break;\n      case '.': putchar(tape[p]); fflush(stdout); break;\n      case ',': { int c = getchar(); tape[p] = (c == EOF) ? 0 : (unsigned char)c; } break;\n      case '[': if(tape[p] == 0) ip = match[ip]; break;\n      case ']': if(tape[p] != 0) ip = match[ip]; break;\n    }\n  }\n\n  free(match);\n  free(stack);\n  free(prog);\n  return 0;\n}\nC\ncc -O2 -s -o /usr/local/bin/bf /tmp/bf.c\nrm -f /tmp/bf.c\nEOF",
+   "/usr/local/bin",
+   "",
+   "bf hello.bf",
+   "++++++++++[>+++++++>++++++++++>+++>+<<<<-]>++.>+.+++++++..+++.>++.<<+++++++++++++++.>.+++.------.--------.>+.>.",
+   "hello.bf", "", "", ""},
+  {"forth", "hello.fs", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends gforth && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "gforth hello.fs",
+   ".\" Hello, world!\" cr bye",
+   "hello.fs", "", "", ""},
+  {"fortran", "hello.f90", "alpine:3.20",
+   "apk add --no-cache build-base gfortran",
+   "",
+   "gfortran hello.f90 -o hello",
+   "./hello",
+   "program hello\n  print '(A)', 'Hello, world!'\nend program hello",
+   "hello.f90", "", "", ""},
+  {"nim", "hello.nim", "alpine:3.20",
+   "apk add --no-cache nim build-base",
+   "",
+   "nim c -d:release -o:hello hello.nim",
+   "./hello",
+   "echo \"Hello, world!\"",
+   "hello.nim", "", "", ""},
+  {"ocaml", "hello.ml", "alpine:3.20",
+   "apk add --no-cache ocaml build-base",
+   "",
+   "ocamlopt -O2 -o hello hello.ml",
+   "./hello",
+   "let () = print_endline \"Hello, world!\"",
+   "hello.ml", "", "", ""},
+  {"kotlin", "Hello.kt", "eclipse-temurin:17-jdk",
+   "apt-get update && DEBIAN_FRONTEND=noninteractive apt-get install -y --no-install-recommends wget unzip && rm -rf /var/lib/apt/lists/* && KOTLIN_VER=2.0.21 && wget -q https://github.com/JetBrains/kotlin/releases/download/v${KOTLIN_VER}/kotlin-compiler-${KOTLIN_VER}.zip -O /tmp/kotlin.zip && unzip -q /tmp/kotlin.zip -d /opt && ln -sf /opt/kotlinc/bin/kotlinc /usr/local/bin/kotlinc && rm -f /tmp/kotlin.zip",
+   "/usr/local/bin",
+   "kotlinc Hello.kt -include-runtime -d hello.jar",
+   "java -jar hello.jar",
+   "fun main() { println(\"Hello, world!\") }",
+   "Hello.kt", "", "", ""},
+  {"scala", "Hello.scala", "eclipse-temurin:17-jdk",
+   "apt-get update && apt-get install -y --no-install-recommends scala && rm -rf /var/lib/apt/lists/*",
+   "",
+   "scalac Hello.scala",
+   "scala Hello",
+   "object Hello extends App { println(\"Hello, world!\") }",
+   "Hello.scala", "", "", ""},
+  {"csharp", "Program.cs", "mcr.microsoft.com/dotnet/sdk:8.0",
+   "",
+   "",
+   "dotnet new console -o app --force && cp Program.cs app/Program.cs && dotnet build app -c Release -v q",
+   "dotnet run --project app -c Release",
+   "using System;\nclass Program {\n  static void Main() {\n    Console.WriteLine(\"Hello, world!\");\n  }\n}",
+   "Program.cs", "large", "large", "2"},
+  {"dart", "hello.dart", "dart:stable",
+   "",
+   "",
+   "",
+   "dart run hello.dart",
+   "void main() { print(\"Hello, world!\"); }",
+   "hello.dart", "", "", ""},
+  {"typescript", "hello.ts", "node:20-alpine",
+   "npm i -g typescript",
+   "",
+   "tsc hello.ts --target ES2020 --module commonjs --outDir dist",
+   "node dist/hello.js",
+   "console.log(\"Hello, world!\");",
+   "hello.ts", "", "", ""},
+  {"zig", "hello.zig", "alpine:3.20",
+   "apk add --no-cache wget tar xz libc-dev && wget -qO- https://ziglang.org/download/0.12.0/zig-linux-aarch64-0.12.0.tar.xz | tar -xJ && mv zig-linux-aarch64-0.12.0 /zig && ln -sf /zig/zig /usr/local/bin/zig",
+   "",
+   "zig build-exe hello.zig -O ReleaseSafe -femit-bin=hello",
+   "./hello",
+   "const std = @import(\"std\"); pub fn main() void { std.debug.print(\"Hello, world!\\n\", .{}); }",
+   "hello.zig", "", "", "2"},
+  {"bash", "hello.sh", "alpine:3.20",
+   "apk add --no-cache bash",
+   "",
+   "",
+   "bash hello.sh",
+   "echo \"Hello, world!\"",
+   "hello.sh", "", "", ""},
+  {"assembly", "hello.S", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends gcc binutils && rm -rf /var/lib/apt/lists/*",
+   "",
+   "gcc -nostdlib -no-pie hello.S -o hello",
+   "./hello",
+   ".global _start\n.text\n_start:\n  mov x0, #1\n  adr x1, msg\n  mov x2, #14\n  mov x8, #64\n  svc #0\n  mov x0, #0\n  mov x8, #93\n  svc #0\n.data\nmsg: .ascii \"Hello, world!\\n\"",
+   "hello.S", "", "", ""},
+  {"haskell", "hello.hs", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends ghc && rm -rf /var/lib/apt/lists/*",
+   "",
+   "ghc -O2 -o hello hello.hs",
+   "./hello",
+   "main = putStrLn \"Hello, world!\"",
+   "hello.hs", "", "", ""},
+  {"elixir", "hello.exs", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends elixir && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "elixir hello.exs",
+   "IO.puts(\"Hello, world!\")",
+   "hello.exs", "", "", ""},
+  {"clojure", "hello.clj", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends clojure default-jre-headless && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "clojure hello.clj",
+   "(println \"Hello, world!\")",
+   "hello.clj", "", "", ""},
+  {"scheme", "hello.scm", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends guile-3.0 && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "guile hello.scm",
+   "(display \"Hello, world!\n\")",
+   "hello.scm", "", "", ""},
+  {"racket", "hello.rkt", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends racket && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "racket hello.rkt",
+   "#lang racket\n(displayln \"Hello, world!\")",
+   "hello.rkt", "", "", ""},
+  {"groovy", "hello.groovy", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends groovy default-jre-headless && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "groovy hello.groovy",
+   "println \"Hello, world!\"",
+   "hello.groovy", "", "", ""},
+  {"d", "hello.d", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends gdc && rm -rf /var/lib/apt/lists/*",
+   "",
+   "gdc -O2 -o hello hello.d",
+   "./hello",
+   "import std.stdio; void main(){ writeln(\"Hello, world!\"); }",
+   "hello.d", "", "", ""},
+  {"ada", "hello.adb", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends gnat && rm -rf /var/lib/apt/lists/*",
+   "",
+   "gnatmake -O2 -o hello hello.adb",
+   "./hello",
+   "with Ada.Text_IO; use Ada.Text_IO; procedure Hello is begin Put_Line(\"Hello, world!\"); end Hello;",
+   "hello.adb", "", "", ""},
+  {"octave", "hello.m", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends octave && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "octave --quiet --no-gui hello.m",
+   "disp(\"Hello, world!\");",
+   "hello.m", "medium", "large", ""},
+  {"powershell", "hello.ps1", "mcr.microsoft.com/powershell:7.4-debian-12",
+   "",
+   "",
+   "",
+   "pwsh -File hello.ps1",
+   "Write-Output \"Hello, world!\"",
+   "hello.ps1", "", "", ""},
+  {"fsharp", "Program.fs", "mcr.microsoft.com/dotnet/sdk:8.0",
+   "",
+   "",
+   "dotnet new console -lang \"F#\" -o app --force && cp Program.fs app/Program.fs && dotnet build app -c Release -v q",
+   "dotnet run --project app -c Release",
+   "open System\n[<EntryPoint>]\nlet main _ =\n  printfn \"Hello, world!\"\n  0",
+   "Program.fs", "large", "large", "2"},
+  {"vbnet", "Program.vb", "mcr.microsoft.com/dotnet/sdk:8.0",
+   "",
+   "",
+   "dotnet new console -lang \"VB\" -o app --force && cp Program.vb app/Program.vb && dotnet build app -c Release -v q",
+   "dotnet run --project app -c Release",
+   "Imports System\nModule Program\n  Sub Main(args As String())\n    Console.WriteLine(\"Hello, world!\")\n  End Sub\nEnd Module",
+   "Program.vb", "large", "large", "2"},
+  {"objective_c", "hello.m", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends gcc gobjc libobjc-12-dev && rm -rf /var/lib/apt/lists/*",
+   "",
+   "gcc -x objective-c -O2 -o hello hello.m -lobjc",
+   "./hello",
+   "#include <stdio.h>\nint main(){ puts(\"Hello, world!\"); return 0; }",
+   "hello.m", "", "", ""},
+  {"bc", "hello.bc", "alpine:3.20",
+   "apk add --no-cache bc",
+   "",
+   "",
+   "bc -q hello.bc",
+   "print \"Hello, world!\n\"",
+   "hello.bc", "", "", ""},
+  {"jq", "hello.jq", "alpine:3.20",
+   "apk add --no-cache jq",
+   "",
+   "",
+   "jq -nr -f hello.jq",
+   "\"Hello, world!\"",
+   "hello.jq", "", "", ""},
+  {"verilog", "hello.v", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends iverilog && rm -rf /var/lib/apt/lists/*",
+   "",
+   "iverilog -o hello hello.v",
+   "vvp hello",
+   "module hello; initial begin $display(\"Hello, world!\"); $finish; end endmodule",
+   "hello.v", "", "", ""},
+  {"sql", "hello.sql", "alpine:3.20",
+   "apk add --no-cache sqlite",
+   "",
+   "",
+   "sqlite3 :memory: < hello.sql",
+   "select 'Hello, world!';",
+   "hello.sql", "", "", ""},
+  {"nimscript", "hello.nims", "alpine:3.20",
+   "apk add --no-cache nim",
+   "",
+   "",
+   "nim e hello.nims",
+   "echo \"Hello, world!\"",
+   "hello.nims", "", "", ""},
+  {"awk_posix", "hello.awk", "alpine:3.20",
+   "",
+   "",
+   "",
+   "awk '{print \"Hello, world!\"}' hello.awk",
+   "BEGIN {}",
+   "hello.awk", "", "", ""},
+  {"cobol", "hello.cob", "debian:bookworm-slim",
+   "apt-get update && DEBIAN_FRONTEND=noninteractive apt-get install -y --no-install-recommends gnucobol build-essential && rm -rf /var/lib/apt/lists/*",
+   "",
+   "cobc -x -free hello.cob -o hello",
+   "./hello",
+   "IDENTIFICATION DIVISION.\nPROGRAM-ID. HELLO.\nPROCEDURE DIVISION.\n    DISPLAY \"Hello, world!\".\n    STOP RUN.",
+   "hello.cob", "", "", ""},
+  {"pascal", "hello.pas", "debian:bookworm-slim",
+   "apt-get update && DEBIAN_FRONTEND=noninteractive apt-get install -y --no-install-recommends fp-compiler && rm -rf /var/lib/apt/lists/*",
+   "",
+   "fpc -O2 hello.pas",
+   "./hello",
+   "program Hello;\nbegin\n  writeln('Hello, world!');\nend.",
+   "hello.pas", "", "", ""},
+  {"abcl", "hello.lisp", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends abcl && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "abcl --load hello.lisp --eval \"(quit)\"",
+   "(format t \"Hello, world!~%\")",
+   "hello.lisp", "", "", ""},
+  {"awk_gawk", "hello.awk", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends gawk && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "gawk -f hello.awk",
+   "BEGIN{print \"Hello, world!\"}",
+   "hello.awk", "", "", ""},
+  {"awk_mawk", "hello.awk", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends mawk && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "mawk -f hello.awk",
+   "BEGIN{print \"Hello, world!\"}",
+   "hello.awk", "", "", ""},
+  {"awk_original", "hello.awk", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends original-awk && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "awk -f hello.awk",
+   "BEGIN{print \"Hello, world!\"}",
+   "hello.awk", "", "", ""},
+  {"basic_yabasic", "hello.bas", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends yabasic && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "yabasic hello.bas",
+   "PRINT \"Hello, world!\"",
+   "hello.bas", "", "", ""},
+  {"bun", "hello.ts", "oven/bun:alpine",
+   "",
+   "",
+   "",
+   "bun run hello.ts",
+   "console.log(\"Hello, world!\");",
+   "hello.ts", "", "", ""},
+  {"chicken", "hello.scm", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends chicken-bin && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "csi -s hello.scm",
+   "(print \"Hello, world!\")",
+   "hello.scm", "", "", ""},
+  {"clisp", "hello.lisp", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends clisp && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "clisp hello.lisp",
+   "(format t \"Hello, world!~%\")",
+   "hello.lisp", "", "", ""},
+  {"coffeescript", "hello.coffee", "node:20-alpine",
+   "npm i -g coffeescript",
+   "",
+   "",
+   "coffee hello.coffee",
+   "console.log \"Hello, world!\"",
+   "hello.coffee", "", "", ""},
+  {"dash", "hello.sh", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends dash && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "dash hello.sh",
+   "echo \"Hello, world!\"",
+   "hello.sh", "", "", ""},
+  {"dc", "hello.dc", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends dc && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "dc -f hello.dc",
+   "[Hello, world!]P",
+   "hello.dc", "", "", ""},
+  {"deno", "hello.ts", "denoland/deno:alpine",
+   "",
+   "",
+   "",
+   "deno run --allow-all hello.ts",
+   "console.log(\"Hello, world!\");",
+   "hello.ts", "", "", ""},
+  {"ecl", "hello.lisp", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends ecl && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "ecl -load hello.lisp -eval \"(quit)\"",
+   "(format t \"Hello, world!~%\")",
+   "hello.lisp", "", "", ""},
+  {"erlang", "hello.erl", "erlang:27-alpine",
+   "",
+   "",
+   "erlc hello.erl",
+   "erl -noshell -s hello main -s init stop",
+   "-module(hello).\n-export([main/0]).\nmain() -> io:format(\"Hello, world!~n\").",
+   "hello.erl", "", "", ""},
+  {"expect", "hello.exp", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends expect && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "expect hello.exp",
+   "puts \"Hello, world!\"",
+   "hello.exp", "", "", ""},
+  {"fish", "hello.fish", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends fish && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "fish hello.fish",
+   "echo \"Hello, world!\"",
+   "hello.fish", "", "", ""},
+  {"gambit", "hello.scm", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends gambc && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "gsi hello.scm",
+   "(display \"Hello, world!\") (newline)",
+   "hello.scm", "", "", ""},
+  {"gnuplot", "hello.gp", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends gnuplot && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "gnuplot -e \"print 'Hello, world!'\"",
+   "print \"Hello, world!\"",
+   "hello.gp", "", "", ""},
+  {"guile", "hello.scm", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends guile-3.0 && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "guile -s hello.scm",
+   "(display \"Hello, world!\") (newline)",
+   "hello.scm", "", "", ""},
+  {"hy", "hello.hy", "python:3.12-slim",
+   "pip install --no-cache-dir hy",
+   "",
+   "",
+   "hy hello.hy",
+   "(print \"Hello, world!\")",
+   "hello.hy", "", "", ""},
+  {"jsonnet", "hello.jsonnet", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends jsonnet && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "jsonnet -S hello.jsonnet",
+   "\"Hello, world!\"",
+   "hello.jsonnet", "", "", ""},
+  {"ksh", "hello.ksh", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends ksh && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "ksh hello.ksh",
+   "echo \"Hello, world!\"",
+   "hello.ksh", "", "", ""},
+  {"livescript", "hello.ls", "node:20-alpine",
+   "npm i -g livescript",
+   "",
+   "",
+   "lsc hello.ls",
+   "console.log 'Hello, world!'",
+   "hello.ls", "", "", ""},
+  {"lua53", "hello.lua", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends lua5.3 && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "lua5.3 hello.lua",
+   "print(\"Hello, world!\")",
+   "hello.lua", "", "", ""},
+  {"lua54", "hello.lua", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends lua5.4 && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "lua5.4 hello.lua",
+   "print(\"Hello, world!\")",
+   "hello.lua", "", "", ""},
+  {"luajit", "hello.lua", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends luajit && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "luajit hello.lua",
+   "print(\"Hello, world!\")",
+   "hello.lua", "", "", ""},
+  {"mksh", "hello.mksh", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends mksh && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "mksh hello.mksh",
+   "echo \"Hello, world!\"",
+   "hello.mksh", "", "", ""},
+  {"prolog_swi", "hello.pl", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends swi-prolog && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "swipl -q -s hello.pl -t main",
+   ":- initialization(main).\nmain :- writeln('Hello, world!').",
+   "hello.pl", "", "", ""},
+  {"raku", "hello.raku", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends rakudo && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "raku hello.raku",
+   "say \"Hello, world!\";",
+   "hello.raku", "", "", ""},
+  {"sbcl", "hello.lisp", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends sbcl && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "sbcl --noinform --script hello.lisp",
+   "(format t \"Hello, world!~%\")",
+   "hello.lisp", "", "", ""},
+  {"v", "hello.v", "thevlang/vlang:alpine",
+   "",
+   "",
+   "v -prod -o hello hello.v",
+   "./hello",
+   "fn main(){println(\"Hello, world!\")}",
+   "hello.v", "", "", ""},
+  {"zsh", "hello.zsh", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends zsh && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "zsh hello.zsh",
+   "echo \"Hello, world!\"",
+   "hello.zsh", "", "", ""},
+  {"crystal", "hello.cr", "crystallang/crystal:latest",
+   "",
+   "",
+   "crystal build hello.cr -o hello",
+   "./hello",
+   "puts \"Hello, world!\"",
+   "hello.cr", "", "", "2"},
+  {"haxe", "Hello.hx", "haxe:latest",
+   "",
+   "",
+   "",
+   "haxe --main Hello --interp",
+   "class Hello { static function main() { Sys.println(\"Hello, world!\"); } }",
+   "Hello.hx", "", "", ""},
+  {"pike", "hello.pike", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends pike8.0 && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "pike8.0 hello.pike",
+   "int main(){ write(\"Hello, world!\\n\"); return 0; }",
+   "hello.pike", "", "", ""},
+  {"rexx", "hello.rexx", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends regina-rexx && rm -rf /var/lib/apt/lists/*",
+   "",
+   "",
+   "rexx ./hello.rexx",
+   "say \"Hello, world!\"",
+   "hello.rexx", "", "", ""},
+  {"janet", "hello.janet", "alpine:3.20",
+   "apk add --no-cache janet",
+   "",
+   "",
+   "janet hello.janet",
+   "(print \"Hello, world!\")",
+   "hello.janet", "", "", ""},
+  {"vala", "hello.vala", "debian:bookworm-slim",
+   "apt-get update && apt-get install -y --no-install-recommends valac build-essential && rm -rf /var/lib/apt/lists/*",
+   "",
+   "valac -o hello hello.vala",
+   "./hello",
+   "using GLib; int main(){ stdout.printf(\"Hello, world!\\n\"); return 0; }",
+   "hello.vala", "", "", ""},
+}};
+
+inline constexpr std::array<uint32_t, 23> kSeeds = {{
+  3, 40, 1, 7, 5, 8, 474, 47, 243, 1085, 2, 63,
+  5, 367, 406, 81, 46, 21, 1, 157, 35, 10, 13
+}};
+inline constexpr std::array<uint16_t, 91> kSlots = {{
+  58, 15, 1, 18, 10, 48, 13, 75, 28, 49, 39, 51,
+  23, 76, 80, 40, 54, 38, 5, 85, 37, 65, 17, 82,
+  32, 77, 66, 41, 0, 31, 22, 46, 45, 6, 9, 86,
+  73, 60, 64, 53, 89, 88, 44, 19, 21, 36, 68, 55,
+  62, 14, 4, 2, 47, 74, 42, 16, 59, 63, 72, 50,
+  71, 26, 20, 67, 81, 52, 30, 78, 7, 70, 34, 25,
+  3, 35, 83, 24, 11, 43, 69, 61, 79, 87, 84, 29,
+  56, 90, 33, 8, 57, 12, 27
+}};
+
+inline constexpr Registry kRegistry = {
+  kEntries.data(), kEntries.size(),
+  kSeeds.data(), kSeeds.size(),
+  kSlots.data(), kSlots.size(),
+  kManifestHash,
+};
+
+static_assert(kRegistry.self_check(), "embedded registry: perfect hash misses a slug");
+
+}  // namespace polyglot::embedded
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "manifest.hpp"
+
+namespace polyglot {
+
+// One language as baked into a generated registry header: the LangSpec fields
+// after fixups and unescaping, pointing into static storage.
+struct RegistryEntry {
+  std::string_view slug;
+  std::string_view file;
+  std::string_view base_image;
+  std::string_view install_cmd;
+  std::string_view env_path;
+  std::string_view build_cmd;
+  std::string_view run_cmd;
+  std::string_view hello;
+  std::string_view effective_file;
+  std::string_view cpu;
+  std::string_view mem;
+  std::string_view width;
+};
+
+// Seeded FNV-1a with a murmur3 finalizer (plain FNV-1a has weak low bits, and
+// the table index is taken modulo a small size).
+constexpr uint64_t registry_hash(uint64_t seed, std::string_view s) {
+  uint64_t h = 14695981039346656037ull ^ (seed * 0x9E3779B97F4A7C15ull);
+  for (char c : s) {
+    h ^= (unsigned char)c;
+    h *= 1099511628211ull;
+  }
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  return h;
+}
+
+// A compile-time language table with a minimal perfect hash over slugs
+// (hash-and-displace): bucket = h(0, slug) % bucket_count, then
+// slot = h(seeds[bucket], slug) % slot_count, and slots[slot] is the entry index.
+// Entries stay in manifest order; each slug appears once (the row that wins).
+struct Registry {
+  const RegistryEntry* entries;
+  size_t count;
+  const uint32_t* seeds;
+  size_t bucket_count;
+  const uint16_t* slots;
+  size_t slot_count;
+  uint64_t manifest_hash;  // fnv1a of the languages.tsv bytes it was generated from
+
+  constexpr const RegistryEntry* find(std::string_view slug) const {
+    if (count == 0) return nullptr;
+    const uint32_t seed = seeds[registry_hash(0, slug) % bucket_count];
+    const uint16_t i = slots[registry_hash(seed, slug) % slot_count];
+    return i < count && entries[i].slug == slug ? &entries[i] : nullptr;
+  }
+
+  // True if every entry is reachable through find(); generated headers static_assert it.
+  constexpr bool self_check() const {
+    for (size_t i = 0; i < count; ++i) {
+      if (find(entries[i].slug) != &entries[i]) return false;
+    }
+    return true;
+  }
+};
+
+// Where `scaffold` keeps the generated header, relative to the repo root.
+extern const char* const kRegistryHeader;
+
+LangSpec to_lang_spec(const RegistryEntry& e);
+
+// Renders the registry header for `manifest`. manifest_hash is recorded so a binary
+// can tell cheaply whether languages.tsv has moved on since it was built.
+std::string emit_registry(const Manifest& manifest, uint64_t manifest_hash);
+
+// Differences between an embedded registry and a runtime parse of the manifest
+// (missing/extra slugs, order, any field). Empty means they agree exactly.
+std::vector<std::string> verify_registry(const Registry& registry, const Manifest& manifest);
+
+}  // namespace polyglot
@@ -0,0 +1,87 @@
+#include "render.hpp"
+
+#include <sstream>
+
+#include "resources.hpp"
+#include "stats.hpp"
+#include "text.hpp"
+
+namespace polyglot {
+
+std::vector<Artifact> render(const LangSpec& spec) {
+  stats::Probe probe(stats::kRender);
+  std::vector<Artifact> out;
+
+  // Ensure build context isn't accidentally excluding everything.
+  out.push_back({".dockerignore",
+                 ".DS_Store\n"
+                 ".git\n"
+                 ".gitignore\n"});
+
+  // Ensure hello ends with newline
+  std::string hello_content = spec.hello;
+  if (!ends_with_nl(hello_content)) hello_content.push_back('\n');
+  Artifact hello{spec.effective_file, hello_content};
+  hello.source = true;
+  out.push_back(std::move(hello));
+
+  // Dockerfile. A declared width becomes build args every RUN step sees, so build
+  // tools use that many threads; the runner overrides POLYGLOT_JOBS when the host has
+  // fewer cores. ARGs don't persist into the image.
+  const Resources declared = declared_resources(spec);
+  std::ostringstream dockerfile;
+  dockerfile
+    << "# syntax=docker/dockerfile:1\n"
+    << "FROM " << spec.base_image << "\n"
+    << "WORKDIR /app\n";
+  if (declared.width) {
+    const auto env = width_env("${POLYGLOT_JOBS}");
+    dockerfile << "ARG " << env[0].first << "=" << declared.width << "\n";
+    for (size_t i = 1; i < env.size(); ++i) dockerfile << "ARG " << env[i].first << "=" << env[i].second << "\n";
+  }
+
+  if (!spec.install_cmd.empty()) {
+    std::string trimmed_install = trim(spec.install_cmd);
+    if (trimmed_install.rfind("<<", 0) == 0) {
+      dockerfile << "RUN " << trimmed_install << "\n";
+    } else {
+      dockerfile << "RUN " << spec.install_cmd << "\n";
+    }
+  }
+
+  if (!spec.env_path.empty())
+    dockerfile << "ENV PATH=\"" << spec.env_path << ":$PATH\"\n";
+
+  dockerfile << "COPY " << spec.effective_file << " .\n";
+  if (!spec.build_cmd.empty()) dockerfile << "RUN " << spec.build_cmd << "\n";
+  dockerfile << "CMD [\"sh\", \"-c\", \"" << json_escape(spec.run_cmd) << "\"]\n";
+
+  out.push_back({"Dockerfile", dockerfile.str()});
+
+  // run.sh: compatibility shim. The polyglot dispatcher does the work when it's
+  // built (profiles, resource limits and width included); otherwise fall back to
+  // calling docker directly.
+  std::ostringstream runsh;
+  runsh
+    << "#!/usr/bin/env bash\n"
+    << "set -euo pipefail\n"
+    << "PG=\"${POLYGLOT_BIN:-${0%/*}/../../polyglot}\"\n"
+    << "if [ -x \"$PG\" ]; then exec \"$PG\" \"${1:-all}\" \"" << spec.slug << "\"; fi\n"
+    << "IMG=\"hello-" << spec.slug << "\"\n"
+    << "PLATFORM=\"${POLYGLOT_PLATFORM:-}\"\n"
+    << "if [ -n \"$PLATFORM\" ]; then\n"
+    << "  docker build --platform \"$PLATFORM\" -t \"$IMG\" .\n"
+    << "  docker run --rm --platform \"$PLATFORM\" \"$IMG\"\n"
+    << "else\n"
+    << "  docker build -t \"$IMG\" .\n"
+    << "  docker run --rm \"$IMG\"\n"
+    << "fi\n";
+
+  Artifact run{"run.sh", runsh.str()};
+  run.executable = true;
+  out.push_back(std::move(run));
+
+  return out;
+}
+
+}  // namespace polyglot
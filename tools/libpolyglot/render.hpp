@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "manifest.hpp"
+
+namespace polyglot {
+
+struct Artifact {
+  std::string name;        // file name inside languages/<slug>/
+  std::string content;
+  bool executable = false;
+  bool source = false;     // the hello program (case-conflict handling applies)
+};
+
+// Renders everything scaffold generates for one language, in write order.
+std::vector<Artifact> render(const LangSpec& spec);
+
+}  // namespace polyglot
@@ -0,0 +1,197 @@
+#include "resources.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#include <unistd.h>
+
+#include "text.hpp"
+#include "tree.hpp"
+
+namespace fs = std::filesystem;
+
+namespace polyglot {
+
+namespace {
+
+struct Class {
+  const char* name;
+  double cpus;
+  uint64_t mem_mb;
+};
+
+constexpr Class kClasses[] = {
+    {"small", 0.5, 256},
+    {"medium", 1, 1024},
+    {"large", 2, 2048},
+    {"xlarge", 4, 4096},
+};
+
+const Class* find_class(const std::string& s) {
+  for (const auto& c : kClasses) {
+    if (s == c.name) return &c;
+  }
+  return nullptr;
+}
+
+// Parses a whole non-negative decimal number; false on trailing junk.
+bool parse_number(const std::string& s, double& out) {
+  if (s.empty()) return false;
+  char* end = nullptr;
+  out = std::strtod(s.c_str(), &end);
+  return end && *end == '\0' && out >= 0;
+}
+
+}  // namespace
+
+double parse_cpu_class(const std::string& s) {
+  const std::string v = lower(trim(s));
+  if (const Class* c = find_class(v)) return c->cpus;
+  double n = 0;
+  if (!parse_number(v, n) || n <= 0) throw std::runtime_error("Bad cpu class: " + s);
+  return n;
+}
+
+uint64_t parse_mem_class(const std::string& s) {
+  std::string v = lower(trim(s));
+  if (const Class* c = find_class(v)) return c->mem_mb;
+  double scale = 1;  // MiB
+  if (!v.empty() && (v.back() == 'g' || v.back() == 'm')) {
+    scale = v.back() == 'g' ? 1024 : 1;
+    v.pop_back();
+  }
+  double n = 0;
+  if (!parse_number(v, n) || n <= 0) throw std::runtime_error("Bad mem class: " + s);
+  return (uint64_t)std::ceil(n * scale);
+}
+
+unsigned parse_width(const std::string& s) {
+  const std::string v = trim(s);
+  double n = 0;
+  if (!parse_number(v, n) || n < 1 || n != std::floor(n)) throw std::runtime_error("Bad width: " + s);
+  return (unsigned)n;
+}
+
+Resources declared_resources(const LangSpec& spec) {
+  Resources r;
+  if (!spec.cpu.empty()) r.cpus = parse_cpu_class(spec.cpu);
+  if (!spec.mem.empty()) r.mem_mb = parse_mem_class(spec.mem);
+  if (!spec.width.empty()) r.width = parse_width(spec.width);
+  return r;
+}
+
+std::vector<std::string> resource_args(const Resources& r) {
+  std::vector<std::string> args;
+  if (r.cpus > 0) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%g", r.cpus);
+    args.insert(args.end(), {"--cpus", buf});
+  }
+  if (r.mem_mb > 0) args.insert(args.end(), {"--memory", std::to_string(r.mem_mb) + "m"});
+  return args;
+}
+
+std::vector<std::pair<std::string, std::string>> width_env(const std::string& value) {
+  return {{"POLYGLOT_JOBS", value}, {"MAKEFLAGS", "-j" + value}, {"OMP_NUM_THREADS", value},
+          {"CARGO_BUILD_JOBS", value}, {"DOTNET_PROCESSOR_COUNT", value}};
+}
+
+std::vector<std::string> width_args(unsigned width) {
+  std::vector<std::string> args;
+  if (width == 0) return args;
+  for (const auto& [name, value] : width_env(std::to_string(width))) args.insert(args.end(), {"-e", name + "=" + value});
+  return args;
+}
+
+std::map<std::string, Resources> observed_resources(const fs::path& history) {
+  std::map<std::string, std::vector<double>> ratios;
+  std::map<std::string, Resources> out;
+  std::ifstream in(history);
+  for (std::string line; std::getline(in, line);) {
+    const auto f = split_tabs(line);
+    if (f.size() < 9 || f[3] != "run" || f[4] != "0" || f[7] == "-") continue;
+    const double wall = std::atof(f[5].c_str());
+    const double cpu = std::atof(f[7].c_str());
+    if (wall > 0) ratios[f[1]].push_back(cpu / wall);
+    if (f[8] != "-") out[f[1]].mem_mb = std::max(out[f[1]].mem_mb, (uint64_t)std::ceil(std::atof(f[8].c_str())));
+  }
+  for (auto& [slug, v] : ratios) {
+    std::sort(v.begin(), v.end());
+    out[slug].cpus = v[std::min(v.size() - 1, (size_t)(0.9 * (double)(v.size() - 1) + 0.5))];
+    if (out[slug].cpus >= 1.5) out[slug].width = (unsigned)std::ceil(out[slug].cpus);
+  }
+  return out;
+}
+
+Resources resource_request(const Resources& declared, const Resources* observed) {
+  const Class& small = kClasses[0];
+  Resources r = declared;
+  if (r.cpus <= 0) r.cpus = observed ? std::max(small.cpus, observed->cpus) : small.cpus;
+  if (r.mem_mb == 0) r.mem_mb = observed ? std::max(small.mem_mb, observed->mem_mb * 3 / 2) : small.mem_mb;
+  if (r.width == 0 && observed) r.width = observed->width;
+  r.cpus = std::max(r.cpus, (double)r.width);
+  return r;
+}
+
+Resources host_capacity() {
+  Resources r;
+  const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  r.cpus = cpus > 0 ? (double)cpus : 1;
+  std::ifstream in("/proc/meminfo");
+  for (std::string key; in >> key;) {
+    uint64_t kb = 0;
+    in >> kb;
+    if (key == "MemTotal:") {
+      r.mem_mb = kb / 1024;
+      break;
+    }
+    in.ignore(1 << 10, '\n');
+  }
+  return r;
+}
+
+CgroupSampler::CgroupSampler(fs::path cidfile) : cidfile_(std::move(cidfile)), thread_([this] { run(); }) {}
+
+CgroupSampler::~CgroupSampler() { stop(); }
+
+void CgroupSampler::stop() {
+  stop_ = true;
+  if (thread_.joinable()) thread_.join();
+}
+
+void CgroupSampler::run() {
+  using namespace std::chrono_literals;
+  // The cidfile is written at create time, before the container's cgroup exists, so
+  // poll for both until the cgroup shows up; a hello world can be gone in well under
+  // a second. If it never does (not visible from here), the readings stay -1 once the
+  // container has exited and stop() is called.
+  fs::path cgroup;
+  while (!stop_ && cgroup.empty()) {
+    const std::string id = trim(read_file_or_empty(cidfile_));
+    if (!id.empty()) {
+      // systemd cgroup driver, then cgroupfs.
+      for (const fs::path& p : {fs::path("/sys/fs/cgroup/system.slice/docker-" + id + ".scope"),
+                                fs::path("/sys/fs/cgroup/docker/" + id)}) {
+        std::error_code ec;
+        if (fs::exists(p / "cpu.stat", ec)) cgroup = p;
+      }
+    }
+    if (cgroup.empty()) std::this_thread::sleep_for(2ms);
+  }
+  while (!cgroup.empty()) {
+    const std::string stat = read_file_or_empty(cgroup / "cpu.stat");
+    const size_t at = stat.find("usage_usec ");
+    if (at != std::string::npos) cpu_s_ = std::atof(stat.c_str() + at + 11) / 1e6;
+    std::string mem = read_file_or_empty(cgroup / "memory.peak");
+    if (mem.empty()) mem = read_file_or_empty(cgroup / "memory.current");
+    if (!mem.empty()) peak_mb_ = std::max(peak_mb_, std::atof(mem.c_str()) / (1024 * 1024));
+    if (stop_) break;
+    std::this_thread::sleep_for(20ms);
+  }
+}
+
+}  // namespace polyglot
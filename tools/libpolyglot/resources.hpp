@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "manifest.hpp"
+
+namespace polyglot {
+
+// ---- resource classes and admission ----
+//
+// Rows may declare what a job needs in optional `cpu` and `mem` columns, either as a
+// class or as an amount:
+//   cpu: small 0.5, medium 1, large 2, xlarge 4 cores, or a number ("1.5")
+//   mem: small 256 MiB, medium 1 GiB, large 2 GiB, xlarge 4 GiB, or "512m" / "3g"
+// Parallel sweeps admit jobs only while the declared (or observed) amounts of the
+// jobs in flight fit the host, and run containers get the declared amounts as hard
+// limits (--cpus, --memory).
+//
+// A `width` column declares a job's own parallelism: how many threads its build or
+// run keeps busy (a `make -j"$(nproc)"`, GHC, cargo). Admission reserves at least
+// that many CPUs, so the widths in flight never add up to more than the host has, and
+// the job is told to use exactly that many (see width_env) on a matching cpuset.
+
+struct Resources {
+  double cpus = 0;      // 0 = unknown
+  uint64_t mem_mb = 0;  // 0 = unknown
+  unsigned width = 0;   // threads the job runs in parallel; 0 = unknown (serial)
+};
+
+// Throw std::runtime_error on anything that isn't a class or an amount.
+double parse_cpu_class(const std::string& s);
+uint64_t parse_mem_class(const std::string& s);
+unsigned parse_width(const std::string& s);
+
+// A row's cpu/mem/width columns; zero for columns left empty.
+Resources declared_resources(const LangSpec& spec);
+
+// `docker run` flags enforcing declared amounts; nothing for unknown ones.
+std::vector<std::string> resource_args(const Resources& r);
+
+// Environment that makes common build tools use `width` threads: POLYGLOT_JOBS,
+// MAKEFLAGS=-j, OMP_NUM_THREADS (which GNU nproc also honours), CARGO_BUILD_JOBS and
+// DOTNET_PROCESSOR_COUNT (what .NET, MSBuild included, takes as the core count).
+// `value` is the thread count as text, so templates can pass "${POLYGLOT_JOBS}".
+std::vector<std::pair<std::string, std::string>> width_env(const std::string& value);
+
+// `docker run` flags setting width_env; nothing for width 0.
+std::vector<std::string> width_args(unsigned width);
+
+// What run containers were seen to use, from history rows that carry the optional
+// cpu-seconds and peak-MiB columns: p90 of cpu-seconds / wall-seconds and the
+// largest peak, per slug. A p90 ratio of 1.5 or more is taken as a parallel job of
+// that width, rounded up.
+std::map<std::string, Resources> observed_resources(const std::filesystem::path& history);
+
+// What admission reserves for a job: the declared amount, else the observed one with
+// 50% memory headroom, never below the small class and never fewer CPUs than the
+// job's width (which is also what a job nobody
+// knows anything about reserves). Builds run inside the Docker daemon where they
+// can't be observed, so rows with heavy builds should declare their class.
+Resources resource_request(const Resources& declared, const Resources* observed);
+
+// Online CPUs and MemTotal.
+Resources host_capacity();
+
+// Samples a running container's cgroup (v2) for its CPU time and peak memory. The
+// container is found through the file `docker run --cidfile` writes. Readings stay
+// negative when the cgroup can't be seen (remote daemon, cgroup v1, Docker Desktop).
+class CgroupSampler {
+ public:
+  explicit CgroupSampler(std::filesystem::path cidfile);
+  ~CgroupSampler();
+  CgroupSampler(const CgroupSampler&) = delete;
+  CgroupSampler& operator=(const CgroupSampler&) = delete;
+
+  // Stops sampling; the readings are final afterwards.
+  void stop();
+  double cpu_seconds() const { return cpu_s_; }
+  double peak_mb() const { return peak_mb_; }
+
+ private:
+  void run();
+
+  std::filesystem::path cidfile_;
+  std::atomic<bool> stop_{false};
+  double cpu_s_ = -1;
+  double peak_mb_ = -1;
+  std::thread thread_;
+};
+
+}  // namespace polyglot
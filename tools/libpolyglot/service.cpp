@@ -0,0 +1,198 @@
+#include "service.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#include <poll.h>
+#include <unistd.h>
+
+#include "affected.hpp"
+#include "render.hpp"
+#include "tree.hpp"
+
+namespace polyglot {
+
+static constexpr size_t kMaxFrame = 64u << 20;
+
+// Time left until `deadline` for poll(): -1 (wait forever) without one, and never
+// negative, so an expired deadline polls once without blocking.
+static int remaining_ms(const std::chrono::steady_clock::time_point* deadline) {
+  if (!deadline) return -1;
+  const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(*deadline - std::chrono::steady_clock::now());
+  return (int)std::max<long long>(0, left.count());
+}
+
+// Waits until fd is ready for `events` or the deadline passes (then throws).
+static void wait_ready(int fd, short events, const std::chrono::steady_clock::time_point* deadline) {
+  if (!deadline) return;
+  for (;;) {
+    pollfd p{fd, events, 0};
+    const int r = ::poll(&p, 1, remaining_ms(deadline));
+    if (r < 0 && errno == EINTR) continue;
+    if (r < 0) throw std::runtime_error(std::string("poll: ") + std::strerror(errno));
+    if (r == 0) throw std::runtime_error("Frame timed out");
+    return;
+  }
+}
+
+// Reads exactly n bytes. Returns the count read before EOF (n unless the peer hung up).
+static size_t read_full(int fd, char* buf, size_t n, const std::chrono::steady_clock::time_point* deadline) {
+  size_t got = 0;
+  while (got < n) {
+    wait_ready(fd, POLLIN, deadline);
+    ssize_t r = ::read(fd, buf + got, n - got);
+    if (r < 0 && errno == EINTR) continue;
+    if (r < 0) throw std::runtime_error(std::string("read: ") + std::strerror(errno));
+    if (r == 0) break;
+    got += (size_t)r;
+  }
+  return got;
+}
+
+static void write_full(int fd, const char* buf, size_t n, const std::chrono::steady_clock::time_point* deadline) {
+  while (n > 0) {
+    wait_ready(fd, POLLOUT, deadline);
+    ssize_t w = ::write(fd, buf, n);
+    if (w < 0 && errno == EINTR) continue;
+    if (w < 0) throw std::runtime_error(std::string("write: ") + std::strerror(errno));
+    buf += w;
+    n -= (size_t)w;
+  }
+}
+
+bool read_frame(int fd, std::string& payload, int timeout_ms) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+  const auto* limit = timeout_ms >= 0 ? &deadline : nullptr;
+  unsigned char len[4];
+  const size_t got = read_full(fd, (char*)len, 4, limit);
+  if (got == 0) return false;
+  if (got != 4) throw std::runtime_error("Truncated frame header");
+  const size_t n = (size_t)len[0] << 24 | (size_t)len[1] << 16 | (size_t)len[2] << 8 | len[3];
+  if (n > kMaxFrame) throw std::runtime_error("Frame too large: " + std::to_string(n));
+  payload.resize(n);
+  if (read_full(fd, &payload[0], n, limit) != n) throw std::runtime_error("Truncated frame");
+  return true;
+}
+
+void write_frame(int fd, const std::string& payload, int timeout_ms) {
+  if (payload.size() > kMaxFrame) throw std::runtime_error("Frame too large: " + std::to_string(payload.size()));
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+  const size_t n = payload.size();
+  std::string buf;
+  buf.reserve(4 + n);
+  buf.push_back((char)(n >> 24));
+  buf.push_back((char)(n >> 16));
+  buf.push_back((char)(n >> 8));
+  buf.push_back((char)n);
+  buf += payload;
+  write_full(fd, buf.data(), buf.size(), timeout_ms >= 0 ? &deadline : nullptr);
+}
+
+void append_record(std::string& body, const std::string& key, const std::string& flags,
+                   const std::string& value) {
+  body += key;
+  body += '\t';
+  body += flags;
+  body += '\t';
+  body += std::to_string(value.size());
+  body += '\n';
+  body += value;
+}
+
+std::vector<Record> parse_records(const std::string& body, size_t pos) {
+  std::vector<Record> out;
+  while (pos < body.size()) {
+    const size_t eol = body.find('\n', pos);
+    const size_t t1 = body.find('\t', pos);
+    const size_t t2 = t1 == std::string::npos ? t1 : body.find('\t', t1 + 1);
+    if (eol == std::string::npos || t2 == std::string::npos || t2 > eol) {
+      throw std::runtime_error("Malformed record");
+    }
+    Record r;
+    r.key = body.substr(pos, t1 - pos);
+    r.flags = body.substr(t1 + 1, t2 - t1 - 1);
+    const size_t n = std::stoull(body.substr(t2 + 1, eol - t2 - 1));
+    if (eol + 1 + n > body.size()) throw std::runtime_error("Truncated record");
+    r.value = body.substr(eol + 1, n);
+    pos = eol + 1 + n;
+    out.push_back(std::move(r));
+  }
+  return out;
+}
+
+Service::Service(std::filesystem::path manifest, std::filesystem::path languages_dir)
+    : manifest_path_(std::move(manifest)), languages_dir_(std::move(languages_dir)) {
+  reload();
+}
+
+void Service::reload() {
+  auto next = std::make_shared<const Manifest>(Manifest::load(manifest_path_));
+  std::lock_guard<std::mutex> lock(mu_);
+  manifest_ = std::move(next);
+}
+
+std::shared_ptr<const Manifest> Service::snapshot() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  return manifest_;
+}
+
+std::string Service::handle(const std::string& request) const {
+  const size_t tab = request.find('\t');
+  const std::string op = request.substr(0, tab);
+  const std::string arg = tab == std::string::npos ? "" : request.substr(tab + 1);
+
+  // One snapshot per request, so a reload mid-request can't mix two manifests.
+  const auto m = snapshot();
+  std::string out = "+";
+  try {
+    if (op == "ping") {
+      return out;
+    }
+    if (op == "slugs") {
+      for (const auto& slug : m->slugs()) append_record(out, slug, "", "");
+      return out;
+    }
+    if (op == "lookup" || op == "render") {
+      const LangSpec* s = m->find(arg);
+      if (!s) return "-Unknown language: " + arg;
+      if (op == "render") {
+        for (const auto& a : render(*s)) append_record(out, a.name, a.executable ? "x" : "", a.content);
+        return out;
+      }
+      append_record(out, "slug", "", s->slug);
+      append_record(out, "file", "", s->file);
+      append_record(out, "base_image", "", s->base_image);
+      append_record(out, "install_cmd", "", s->install_cmd);
+      append_record(out, "env_path", "", s->env_path);
+      append_record(out, "build_cmd", "", s->build_cmd);
+      append_record(out, "run_cmd", "", s->run_cmd);
+      append_record(out, "hello", "", s->hello);
+      append_record(out, "effective_file", "", s->effective_file);
+      append_record(out, "cpu", "", s->cpu);
+      append_record(out, "mem", "", s->mem);
+      append_record(out, "width", "", s->width);
+      return out;
+    }
+    if (op == "affected") {
+      if (arg.empty()) return "-affected needs a git revision";
+      for (const auto& slug : affected_slugs(*m, manifest_path_, arg)) append_record(out, slug, "", "");
+      return out;
+    }
+    if (op == "check") {
+      for (const auto& d : check_tree(*m, languages_dir_)) {
+        for (const auto& f : d.added)   append_record(out, d.slug, "added", f);
+        for (const auto& f : d.changed) append_record(out, d.slug, "changed", f);
+        for (const auto& f : d.removed) append_record(out, d.slug, "removed", f);
+      }
+      return out;
+    }
+    return "-Unknown op: " + op;
+  } catch (const std::exception& e) {
+    return std::string("-") + e.what();
+  }
+}
+
+}  // namespace polyglot
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "manifest.hpp"
+
+// The `scaffold serve` protocol, usable from any client that can speak to a unix socket.
+//
+// Every message is a frame: a 4-byte big-endian length, then that many bytes.
+// A request is "<op>" or "<op>\t<arg>". A response starts with a status byte,
+// '+' (ok) or '-' (error, the rest is the message), followed by zero or more
+// records: "<key>\t<flags>\t<length>\n" and then exactly <length> bytes of value.
+//
+//   ping              -> no records
+//   slugs             -> one record per slug, manifest order
+//   lookup <slug>     -> one record per LangSpec field (key = field name)
+//   render <slug>     -> one record per artifact (key = file name, flags "x" if executable)
+//   affected <rev>    -> one record per affected slug
+//   check             -> one record per drifting file (key = slug, flags = added|changed|removed,
+//                        value = file name)
+//
+// A connection may carry any number of requests; responses come back in order.
+namespace polyglot {
+
+// Reads one frame. Returns false on a clean EOF before the frame starts; throws on
+// a short read, an I/O error, or a frame over the size limit. With timeout_ms >= 0
+// the whole frame must arrive (or, writing, be sent) within that time, however it
+// trickles in; otherwise throws.
+bool read_frame(int fd, std::string& payload, int timeout_ms = -1);
+void write_frame(int fd, const std::string& payload, int timeout_ms = -1);
+
+struct Record {
+  std::string key;
+  std::string flags;
+  std::string value;
+};
+
+void append_record(std::string& body, const std::string& key, const std::string& flags,
+                   const std::string& value);
+// Parses the records following the status byte; throws on malformed input.
+std::vector<Record> parse_records(const std::string& body, size_t pos = 1);
+
+// Answers requests against an in-memory manifest. handle() is safe to call from
+// many threads at once, including while reload() swaps in a new snapshot.
+class Service {
+ public:
+  // languages_dir is what `check` compares against; affected runs git in the cwd.
+  Service(std::filesystem::path manifest, std::filesystem::path languages_dir);
+
+  // Re-reads the manifest. On failure the previous snapshot stays live and this throws.
+  void reload();
+
+  std::string handle(const std::string& request) const;
+
+ private:
+  std::shared_ptr<const Manifest> snapshot() const;
+
+  std::filesystem::path manifest_path_;
+  std::filesystem::path languages_dir_;
+  mutable std::mutex mu_;
+  std::shared_ptr<const Manifest> manifest_;
+};
+
+}  // namespace polyglot
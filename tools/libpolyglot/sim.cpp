@@ -0,0 +1,236 @@
+#include "sim.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+#include "locality.hpp"
+#include "text.hpp"
+#include "tree.hpp"
+
+namespace polyglot {
+
+std::map<std::string, SlugProfile> history_profiles(const std::filesystem::path& history) {
+  std::map<std::string, SlugProfile> out;
+  std::map<std::string, std::pair<size_t, size_t>> attempts;  // slug -> (failed, total)
+  std::ifstream in(history);
+  for (std::string line; std::getline(in, line);) {
+    const auto f = split_tabs(line);
+    if (f.size() < 6) continue;
+    const std::string& slug = f[1];
+    const bool ok = f[4] == "0";
+    auto& a = attempts[slug];
+    a.second++;
+    if (!ok) {
+      a.first++;
+      continue;
+    }
+    SlugProfile& p = out[slug];
+    p.slug = slug;
+    (f[3] == "build" ? p.build_s : p.run_s).push_back(std::atof(f[5].c_str()));
+  }
+  for (auto& [slug, p] : out) {
+    const auto& a = attempts[slug];
+    p.fail_rate = a.second ? (double)a.first / (double)a.second : 0;
+  }
+  return out;
+}
+
+SlugProfile synthetic_profile(const std::string& slug, const std::string& base_image, uint64_t seed) {
+  std::mt19937_64 rng(fnv1a(slug) ^ seed);
+  std::lognormal_distribution<double> build(std::log(40.0), 0.8), run(std::log(0.8), 0.6), mem(std::log(300.0), 0.9);
+  SlugProfile p;
+  p.slug = slug;
+  p.base_image = base_image;
+  for (int i = 0; i < 8; ++i) {
+    p.build_s.push_back(build(rng));
+    p.run_s.push_back(run(rng));
+  }
+  p.fail_rate = 0.02;
+  p.mem_mb = mem(rng);
+  return p;
+}
+
+const char* sim_policy_name(SimPolicy policy) {
+  switch (policy) {
+    case SimPolicy::kFifo: return "fifo";
+    case SimPolicy::kLpt: return "lpt";
+    case SimPolicy::kLocality: return "locality";
+    case SimPolicy::kAdaptive: return "adaptive";
+    case SimPolicy::kShard: return "shard";
+  }
+  return "?";
+}
+
+SimPolicy sim_policy_named(const std::string& name) {
+  for (SimPolicy p : {SimPolicy::kFifo, SimPolicy::kLpt, SimPolicy::kLocality, SimPolicy::kAdaptive, SimPolicy::kShard}) {
+    if (name == sim_policy_name(p)) return p;
+  }
+  throw std::runtime_error("Unknown policy: " + name + " (expected fifo, lpt, locality, adaptive or shard)");
+}
+
+namespace {
+
+double mean(const std::vector<double>& v) {
+  return v.empty() ? 0 : std::accumulate(v.begin(), v.end(), 0.0) / (double)v.size();
+}
+
+double sample(const std::vector<double>& v, std::mt19937_64& rng) {
+  if (v.empty()) return 0;
+  return v[std::uniform_int_distribution<size_t>(0, v.size() - 1)(rng)];
+}
+
+double percentile(std::vector<double> v, double p) {
+  if (v.empty()) return 0;
+  std::sort(v.begin(), v.end());
+  return v[std::min(v.size() - 1, (size_t)(p * (double)(v.size() - 1) + 0.5))];
+}
+
+// Job indices in the order the policy starts them.
+std::vector<size_t> policy_order(const std::vector<SlugProfile>& profiles, SimPolicy policy) {
+  std::vector<size_t> order(profiles.size());
+  std::iota(order.begin(), order.end(), 0);
+  if (policy == SimPolicy::kLpt || policy == SimPolicy::kAdaptive) {
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return mean(profiles[a].build_s) + mean(profiles[a].run_s) > mean(profiles[b].build_s) + mean(profiles[b].run_s);
+    });
+  } else if (policy == SimPolicy::kLocality) {
+    std::vector<ImageInfo> images;
+    std::map<std::string, size_t> index;
+    for (size_t i = 0; i < profiles.size(); ++i) {
+      images.push_back({profiles[i].slug, profiles[i].base_image, {}});
+      index[profiles[i].slug] = i;
+    }
+    order.clear();
+    for (const auto& slug : locality_order(images)) order.push_back(index[slug]);
+  }
+  return order;
+}
+
+struct Running {
+  double end;
+  double mem;
+  size_t worker;
+  bool pressure;
+  bool operator>(const Running& o) const { return end > o.end; }
+};
+
+}  // namespace
+
+SimReport simulate(const std::vector<SlugProfile>& profiles, SimPolicy policy, const SimOptions& opts,
+                   size_t sweeps, uint64_t seed) {
+  SimReport report;
+  report.policy = policy;
+  report.sweeps = sweeps;
+  const unsigned slots = std::max(1u, opts.slots);
+  const std::vector<size_t> order = policy_order(profiles, policy);
+  std::mt19937_64 rng(seed);
+  std::uniform_real_distribution<double> coin(0, 1);
+
+  std::vector<double> makespans, waits;
+  double utilization = 0;
+  size_t failed = 0, jobs = 0;
+  for (size_t s = 0; s < sweeps; ++s) {
+    // Per-worker queues for sharding; one shared queue otherwise.
+    std::vector<std::vector<size_t>> queues(policy == SimPolicy::kShard ? slots : 1);
+    for (size_t k = 0; k < order.size(); ++k) queues[k % queues.size()].push_back(order[k]);
+    for (auto& q : queues) std::reverse(q.begin(), q.end());  // pop from the back
+    std::vector<bool> worker_busy(slots, false);
+
+    std::priority_queue<Running, std::vector<Running>, std::greater<Running>> running;
+    std::deque<std::string> warm;  // most recently used base image first
+    double t = 0, busy = 0, mem = 0;
+    unsigned limit = slots;
+
+    auto start = [&](size_t i, size_t worker) {
+      const SlugProfile& p = profiles[i];
+      double build = sample(p.build_s, rng);
+      auto hit = std::find(warm.begin(), warm.end(), p.base_image);
+      if (hit == warm.end()) build *= 1 + opts.cold_penalty;
+      else warm.erase(hit);
+      warm.push_front(p.base_image);
+      if (warm.size() > opts.warm_images) warm.pop_back();
+      double d = build + sample(p.run_s, rng);
+      for (int tries = 0; coin(rng) < p.fail_rate; ++tries) {
+        if (tries >= opts.retries) {
+          ++failed;
+          break;
+        }
+        d += sample(p.run_s, rng);
+      }
+      mem += p.mem_mb;
+      const bool pressure = mem > opts.mem_mb;
+      if (pressure) d *= opts.mem_slowdown;
+      busy += d;
+      waits.push_back(t);
+      worker_busy[worker] = true;
+      running.push({t + d, p.mem_mb, worker, pressure});
+      ++jobs;
+    };
+
+    for (;;) {
+      for (size_t w = 0; w < slots && running.size() < limit; ++w) {
+        if (worker_busy[w]) continue;
+        auto& q = queues[policy == SimPolicy::kShard ? w : 0];
+        if (q.empty()) continue;
+        const size_t i = q.back();
+        q.pop_back();
+        start(i, w);
+      }
+      if (running.empty()) break;
+      const Running done = running.top();
+      running.pop();
+      t = done.end;
+      mem -= done.mem;
+      worker_busy[done.worker] = false;
+      if (policy == SimPolicy::kAdaptive) limit = done.pressure ? std::max(1u, limit / 2) : std::min(slots, limit + 1);
+    }
+    makespans.push_back(t);
+    if (t > 0) utilization += busy / (slots * t);
+  }
+
+  report.makespan_mean = mean(makespans);
+  report.makespan_p95 = percentile(makespans, 0.95);
+  report.utilization = sweeps ? utilization / (double)sweeps : 0;
+  report.queue_wait_p95 = percentile(std::move(waits), 0.95);
+  report.fail_rate = jobs ? (double)failed / (double)jobs : 0;
+  return report;
+}
+
+SimBackend::SimBackend(std::map<std::string, SlugProfile> profiles, double time_scale, uint64_t seed)
+    : profiles_(std::move(profiles)), time_scale_(time_scale), seed_(seed) {}
+
+PhaseResult SimBackend::run(const std::string& slug, const std::string& phase, const Placement&) {
+  double secs = 0;
+  bool fail = false;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = profiles_.find(slug);
+    if (it == profiles_.end()) it = profiles_.emplace(slug, synthetic_profile(slug, "", seed_)).first;
+    // Seeded by (seed, slug, phase, attempt), never by call order across workers, so
+    // the same sweep fails the same jobs whatever the thread timing.
+    const std::string key = slug + "\t" + phase;
+    std::mt19937_64 rng(seed_ ^ fnv1a(key) ^ (++attempts_[key] * 0x9E3779B97F4A7C15ull));
+    secs = sample(phase == "build" ? it->second.build_s : it->second.run_s, rng);
+    fail = std::uniform_real_distribution<double>(0, 1)(rng) < it->second.fail_rate;
+  }
+  if (time_scale_ > 0) std::this_thread::sleep_for(std::chrono::duration<double>(secs * time_scale_));
+
+  PhaseResult r;
+  if (fail) {
+    r.status = 1;
+    r.err = "simulated " + phase + " failure\n";
+  } else if (phase == "run") {
+    r.out = "Hello from " + slug + " (simulated)\n";
+  }
+  return r;
+}
+
+}  // namespace polyglot
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "sweep.hpp"
+
+namespace polyglot {
+
+// ---- scheduler simulation ----
+//
+// Replays sweeps under virtual time so scheduling policies can be compared over
+// thousands of sweeps in seconds instead of one noisy sweep per hour of Docker.
+
+// What a slug costs, as observed in the history store or drawn from synthetic
+// distributions.
+struct SlugProfile {
+  std::string slug;
+  std::string base_image;
+  std::vector<double> build_s;  // observed durations of passing attempts; sampled uniformly
+  std::vector<double> run_s;
+  double fail_rate = 0;         // fraction of phase attempts that failed
+  double mem_mb = 256;          // resident footprint while the job runs
+};
+
+// Profiles from history.tsv rows (see run_all.sh), keyed by slug. Slugs absent from
+// the history get nothing; see synthetic_profile.
+std::map<std::string, SlugProfile> history_profiles(const std::filesystem::path& history);
+
+// A deterministic made-up profile for a slug: lognormal build (median 40 s) and run
+// (median 0.8 s) times, a 2% failure rate and a lognormal footprint (median 300 MiB).
+SlugProfile synthetic_profile(const std::string& slug, const std::string& base_image, uint64_t seed);
+
+enum class SimPolicy {
+  kFifo,       // the given order, fixed concurrency
+  kLpt,        // longest expected job first
+  kLocality,   // same-base images back to back (locality_order)
+  kAdaptive,   // LPT with concurrency that grows while memory is free and halves under pressure
+  kShard,      // slugs dealt round-robin to fixed per-slot queues, no work stealing
+};
+
+const char* sim_policy_name(SimPolicy policy);
+// "fifo", "lpt", "locality", "adaptive" or "shard"; throws std::runtime_error otherwise.
+SimPolicy sim_policy_named(const std::string& name);
+
+struct SimOptions {
+  unsigned slots = 4;          // concurrency for fixed policies; capacity for utilization
+  double mem_mb = 16384;       // host memory; running beyond it slows jobs by mem_slowdown
+  double mem_slowdown = 2.0;
+  double cold_penalty = 0.3;   // extra build time fraction when the base image isn't cached
+  size_t warm_images = 8;      // base images the page cache holds (LRU)
+  int retries = 0;             // run-phase retries after a failure, as run_all.sh --retries
+};
+
+struct SimReport {
+  SimPolicy policy;
+  size_t sweeps = 0;
+  double makespan_mean = 0;
+  double makespan_p95 = 0;
+  double utilization = 0;      // busy slot-seconds / (slots * makespan), averaged
+  double queue_wait_p95 = 0;   // seconds from sweep start to job start, over all jobs
+  double fail_rate = 0;        // jobs failed after retries / jobs
+};
+
+// Simulates `sweeps` sweeps of `profiles` under `policy`. Deterministic for a seed.
+SimReport simulate(const std::vector<SlugProfile>& profiles, SimPolicy policy, const SimOptions& opts,
+                   size_t sweeps, uint64_t seed);
+
+// A fake container backend for the real scheduler: phases pass or fail at the
+// profile's rate and "take" a sampled duration, slept at time_scale (0 = instant).
+// Run output is "Hello from <slug> (simulated)".
+class SimBackend : public SweepBackend {
+ public:
+  SimBackend(std::map<std::string, SlugProfile> profiles, double time_scale, uint64_t seed);
+
+  PhaseResult run(const std::string& slug, const std::string& phase, const Placement& placement) override;
+
+ private:
+  std::map<std::string, SlugProfile> profiles_;
+  double time_scale_;
+  uint64_t seed_;
+  std::mutex mu_;
+  std::map<std::string, uint64_t> attempts_;  // "slug\tphase" -> calls so far; seeds each call
+};
+
+}  // namespace polyglot
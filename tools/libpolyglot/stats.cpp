@@ -0,0 +1,93 @@
+#include "stats.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+namespace polyglot::stats {
+
+#ifndef POLYGLOT_NO_STATS
+bool g_enabled = false;
+#endif
+
+namespace {
+
+const char* const kPhaseNames[kPhaseCount] = {
+  "manifest_read", "parse_row", "unescape", "fixups", "resolve_file",
+  "render", "conflict_removal", "write_file", "chmod",
+};
+
+struct State {
+  std::mutex mu;
+  std::vector<uint64_t> samples[kPhaseCount];
+  uint64_t counters[kCounterCount] = {};
+  uint64_t started = 0;
+};
+
+State& state() {
+  static State s;
+  return s;
+}
+
+uint64_t percentile(const std::vector<uint64_t>& sorted, double p) {
+  if (sorted.empty()) return 0;
+  size_t i = (size_t)(p * (double)(sorted.size() - 1) + 0.5);
+  return sorted[std::min(i, sorted.size() - 1)];
+}
+
+}  // namespace
+
+void enable() {
+#ifndef POLYGLOT_NO_STATS
+  g_enabled = true;
+#endif
+  state().started = now_ns();
+}
+
+uint64_t now_ns() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void record(Phase phase, uint64_t ns) {
+  State& s = state();
+  std::lock_guard<std::mutex> lock(s.mu);
+  s.samples[phase].push_back(ns);
+}
+
+void add_slow(Counter counter, uint64_t n) {
+  State& s = state();
+  std::lock_guard<std::mutex> lock(s.mu);
+  s.counters[counter] += n;
+}
+
+void report(std::ostream& out) {
+  State& s = state();
+  std::lock_guard<std::mutex> lock(s.mu);
+  char line[160];
+  std::snprintf(line, sizeof(line), "%-17s %8s %10s %9s %9s %9s %9s\n", "phase", "count", "total ms", "p50 us",
+                "p90 us", "p99 us", "max us");
+  out << line;
+  for (unsigned p = 0; p < kPhaseCount; ++p) {
+    std::vector<uint64_t> v = s.samples[p];
+    if (v.empty()) continue;
+    std::sort(v.begin(), v.end());
+    uint64_t total = 0;
+    for (uint64_t ns : v) total += ns;
+    std::snprintf(line, sizeof(line), "%-17s %8zu %10.3f %9.1f %9.1f %9.1f %9.1f\n", kPhaseNames[p], v.size(),
+                  total / 1e6, percentile(v, 0.50) / 1e3, percentile(v, 0.90) / 1e3, percentile(v, 0.99) / 1e3,
+                  v.back() / 1e3);
+    out << line;
+  }
+  out << "Bytes read: " << s.counters[kBytesRead] << ", written: " << s.counters[kBytesWritten] << " ("
+      << s.counters[kFilesWritten] << " files written, " << s.counters[kFilesUnchanged] << " unchanged)\n";
+  if (s.started) {
+    std::snprintf(line, sizeof(line), "Wall: %.3f ms\n", (now_ns() - s.started) / 1e6);
+    out << line;
+  }
+}
+
+}  // namespace polyglot::stats
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Lightweight phase timers and counters behind `scaffold --stats`.
+//
+// Probes cost one load and a predictable branch while stats are off (the default);
+// build with -DPOLYGLOT_NO_STATS to compile them out entirely. Recording takes a
+// mutex, so enabled probes are safe from several threads but meant for CLI runs.
+namespace polyglot::stats {
+
+enum Phase : unsigned {
+  kManifestRead,
+  kParseRow,
+  kUnescape,
+  kFixups,
+  kResolveFile,
+  kRender,
+  kConflictRemoval,
+  kWriteFile,
+  kChmod,
+  kPhaseCount,
+};
+
+enum Counter : unsigned {
+  kBytesRead,
+  kBytesWritten,
+  kFilesWritten,
+  kFilesUnchanged,
+  kCounterCount,
+};
+
+#ifdef POLYGLOT_NO_STATS
+constexpr bool enabled() { return false; }
+#else
+extern bool g_enabled;
+inline bool enabled() { return g_enabled; }
+#endif
+
+void enable();
+uint64_t now_ns();
+void record(Phase phase, uint64_t ns);
+void add_slow(Counter counter, uint64_t n);
+
+inline void add(Counter counter, uint64_t n) {
+  if (enabled()) add_slow(counter, n);
+}
+
+// Prints per-phase count, total and p50/p90/p99/max, then the counters.
+void report(std::ostream& out);
+
+// Times its scope into `phase`.
+class Probe {
+ public:
+  explicit Probe(Phase phase) : phase_(phase), start_(enabled() ? now_ns() : 0) {}
+  ~Probe() {
+    if (start_) record(phase_, now_ns() - start_);
+  }
+  Probe(const Probe&) = delete;
+  Probe& operator=(const Probe&) = delete;
+
+ private:
+  Phase phase_;
+  uint64_t start_;
+};
+
+}  // namespace polyglot::stats
@@ -0,0 +1,372 @@
+#include "sweep.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "stats.hpp"
+
+extern char** environ;
+
+namespace polyglot {
+
+PhaseResult spawn_phase(const std::vector<std::string>& args, const std::string* input) {
+  PhaseResult r;
+  std::vector<char*> argv;
+  for (const auto& a : args) argv.push_back(const_cast<char*>(a.c_str()));
+  argv.push_back(nullptr);
+
+  FILE* files[2] = {std::tmpfile(), std::tmpfile()};
+  int pipefd[2] = {-1, -1};
+  if (!files[0] || !files[1] || (input && ::pipe2(pipefd, O_CLOEXEC) != 0)) {
+    r.err = std::string("Cannot capture output: ") + std::strerror(errno) + "\n";
+    for (FILE* f : files) {
+      if (f) std::fclose(f);
+    }
+    r.status = 127;
+    return r;
+  }
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  if (input) posix_spawn_file_actions_adddup2(&actions, pipefd[0], 0);
+  else posix_spawn_file_actions_addopen(&actions, 0, "/dev/null", O_RDONLY, 0);
+  posix_spawn_file_actions_adddup2(&actions, fileno(files[0]), 1);
+  posix_spawn_file_actions_adddup2(&actions, fileno(files[1]), 2);
+
+  pid_t pid;
+  const int rc = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+  posix_spawn_file_actions_destroy(&actions);
+  if (rc == 0) r.spawned_ns = stats::now_ns();
+  if (input) {
+    ::close(pipefd[0]);
+    if (rc == 0) {
+      // A child that exits early just closes the pipe; treat EPIPE as end of input.
+      std::signal(SIGPIPE, SIG_IGN);
+      for (size_t off = 0; off < input->size();) {
+        ssize_t w = ::write(pipefd[1], input->data() + off, input->size() - off);
+        if (w < 0 && errno == EINTR) continue;
+        if (w < 0) break;
+        off += (size_t)w;
+      }
+    }
+    ::close(pipefd[1]);
+  }
+
+  int status = 0;
+  if (rc == 0) {
+    while (waitpid(pid, &status, 0) < 0) {
+      if (errno != EINTR) break;
+    }
+    r.exited_ns = stats::now_ns();
+  }
+  std::string* dest[2] = {&r.out, &r.err};
+  for (int i = 0; i < 2; ++i) {
+    std::rewind(files[i]);
+    char buf[16384];
+    for (size_t n; (n = std::fread(buf, 1, sizeof(buf), files[i])) > 0;) dest[i]->append(buf, n);
+    std::fclose(files[i]);
+  }
+  if (rc != 0) {
+    r.err += "Failed to start " + args[0] + ": " + std::strerror(rc) + "\n";
+    r.status = 127;
+  } else if (WIFEXITED(status)) {
+    r.status = WEXITSTATUS(status);
+  } else {
+    r.status = WIFSIGNALED(status) ? 128 + WTERMSIG(status) : 1;
+  }
+  return r;
+}
+
+static double percentile_us(std::vector<double> v, double p) {
+  if (v.empty()) return 0;
+  std::sort(v.begin(), v.end());
+  return v[std::min(v.size() - 1, (size_t)(p * (double)(v.size() - 1) + 0.5))];
+}
+
+std::string SweepOverhead::summary() const {
+  double cpu = 0;
+  for (double us : cpu_us) cpu += us;
+  char line[256];
+  std::snprintf(line, sizeof(line),
+                "cpu %.0f us/job, launch p50 %.0f us p95 %.0f us, record p50 %.0f us p95 %.0f us, "
+                "process cpu %.1f ms over %zu jobs",
+                jobs ? cpu / (double)jobs : 0, percentile_us(launch_us, 0.5), percentile_us(launch_us, 0.95),
+                percentile_us(record_us, 0.5), percentile_us(record_us, 0.95), process_cpu_us / 1e3, jobs);
+  return line;
+}
+
+std::string last_clean_line(const std::string& text) {
+  std::string clean;
+  clean.reserve(text.size());
+  for (size_t i = 0; i < text.size(); ++i) {
+    if (text[i] == '\x1b' && i + 1 < text.size() && text[i + 1] == '[') {
+      i += 2;
+      while (i < text.size() && !((text[i] >= 'A' && text[i] <= 'Z') || (text[i] >= 'a' && text[i] <= 'z'))) ++i;
+      continue;
+    }
+    if (text[i] != '\r') clean += text[i];
+  }
+  size_t end = clean.size();
+  while (end > 0) {
+    const size_t start = clean.rfind('\n', end - 1);
+    const size_t from = start == std::string::npos ? 0 : start + 1;
+    const std::string line = clean.substr(from, end - from);
+    if (line.find_first_not_of(" \t\f\v") != std::string::npos) return line;
+    if (start == std::string::npos) break;
+    end = start;
+  }
+  return "";
+}
+
+namespace {
+
+uint64_t rusage_us(int who) {
+  struct rusage ru;
+  if (getrusage(who, &ru) != 0) return 0;
+  return (uint64_t)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000 + ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+}
+
+// This thread's CPU time, where the platform can tell it apart from the process's.
+uint64_t thread_cpu_us() {
+#ifdef RUSAGE_THREAD
+  return rusage_us(RUSAGE_THREAD);
+#else
+  return rusage_us(RUSAGE_SELF);
+#endif
+}
+
+class Sweep {
+ public:
+  Sweep(const std::vector<std::string>& slugs, SweepBackend& backend, const SweepOptions& opts,
+        const std::function<void(const JobResult&)>& on_done, SweepOverhead* overhead)
+      : slugs_(slugs), backend_(backend), opts_(opts), on_done_(on_done), overhead_(overhead) {
+    if (!opts_.history.empty()) history_.open(opts_.history, std::ios::app);
+#ifdef CPU_SETSIZE
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+      for (int c = 0; c < CPU_SETSIZE; ++c) {
+        if (CPU_ISSET(c, &set)) cores_.push_back(c);
+      }
+    }
+#endif
+    core_busy_.assign(cores_.size(), false);
+  }
+
+  size_t run() {
+    std::vector<std::thread> workers;
+    const size_t n = std::min<size_t>(std::max(1u, opts_.jobs), slugs_.size());
+    for (size_t i = 0; i < n; ++i) workers.emplace_back([this] { work(); });
+    for (auto& t : workers) t.join();
+    if (overhead_) overhead_->process_cpu_us = (double)rusage_us(RUSAGE_SELF);
+    return failures_;
+  }
+
+ private:
+  void work() {
+    for (;;) {
+      Resources held;
+      std::vector<size_t> cores;
+      const size_t i = admit(held, cores);
+      if (i >= slugs_.size()) return;
+      const uint64_t cpu0 = overhead_ ? thread_cpu_us() : 0;
+      Timing timing;
+      timing.ready_ns = stats::now_ns();
+      JobResult r = job(slugs_[i], held.width, cores, timing);
+      // Before waking anyone, for fail_fast.
+      if (r.status != 0 && !opts_.non_blocking.count(r.slug)) ++failures_;
+      release(held, cores);
+      std::lock_guard<std::mutex> lock(done_mu_);
+      on_done_(r);
+      if (overhead_) {
+        const uint64_t recorded = stats::now_ns();
+        overhead_->jobs++;
+        overhead_->cpu_us.push_back((double)(thread_cpu_us() - cpu0));
+        overhead_->launch_us.push_back(timing.launch_ns / 1e3);
+        if (timing.last_exit_ns) overhead_->record_us.push_back((recorded - timing.last_exit_ns) / 1e3);
+      }
+    }
+  }
+
+  bool admitting() const { return opts_.capacity.cpus > 0 || opts_.capacity.mem_mb > 0; }
+
+  // The request admission reserves for a slug, clamped to the host so that an
+  // oversized job can still run (alone), with a width no wider than the host.
+  Resources request(const std::string& slug) const {
+    const auto it = opts_.requests.find(slug);
+    Resources r = it == opts_.requests.end() ? resource_request({}, nullptr) : it->second;
+    if (opts_.capacity.cpus > 0) {
+      r.cpus = std::min(r.cpus, opts_.capacity.cpus);
+      r.width = std::min(r.width, std::max(1u, (unsigned)opts_.capacity.cpus));
+    }
+    if (opts_.capacity.mem_mb > 0) r.mem_mb = std::min(r.mem_mb, opts_.capacity.mem_mb);
+    return r;
+  }
+
+  bool fits(const Resources& r) const {
+    if (running_ == 0 || !admitting()) return true;
+    if (opts_.capacity.cpus > 0 && used_.cpus + r.cpus > opts_.capacity.cpus + 1e-9) return false;
+    return opts_.capacity.mem_mb == 0 || used_.mem_mb + r.mem_mb <= opts_.capacity.mem_mb;
+  }
+
+  // Blocks until some not-yet-started job fits (first fit in sweep order) and takes it;
+  // slugs_.size() once there is nothing left to start. A parallel job off NUMA
+  // placement also gets `width` cores no other parallel job holds, if that many are
+  // free (a capacity larger than the real CPUs can leave it unpinned).
+  size_t admit(Resources& held, std::vector<size_t>& cores) {
+    std::unique_lock<std::mutex> lock(queue_mu_);
+    for (;;) {
+      if (opts_.fail_fast && failures_ > 0) return slugs_.size();
+      while (first_ < slugs_.size() && taken_[first_]) ++first_;
+      if (first_ == slugs_.size()) return first_;
+      for (size_t i = first_; i < slugs_.size(); ++i) {
+        if (taken_[i]) continue;
+        const Resources r = request(slugs_[i]);
+        if (!fits(r)) continue;
+        taken_[i] = true;
+        ++running_;
+        used_.cpus += r.cpus;
+        used_.mem_mb += r.mem_mb;
+        held = r;
+        const size_t free = (size_t)std::count(core_busy_.begin(), core_busy_.end(), false);
+        for (size_t c = 0; c < cores_.size() && r.width > 1 && free >= r.width && !opts_.balancer; ++c) {
+          if (core_busy_[c] || cores.size() == r.width) continue;
+          core_busy_[c] = true;
+          cores.push_back(c);
+        }
+        return i;
+      }
+      room_.wait(lock);
+    }
+  }
+
+  void release(const Resources& held, const std::vector<size_t>& cores) {
+    {
+      std::lock_guard<std::mutex> lock(queue_mu_);
+      for (size_t c : cores) core_busy_[c] = false;
+      --running_;
+      used_.cpus -= held.cpus;
+      used_.mem_mb -= held.mem_mb;
+    }
+    room_.notify_all();
+  }
+
+  // Where a job's wall time went outside its children.
+  struct Timing {
+    uint64_t ready_ns = 0;
+    uint64_t last_exit_ns = 0;  // previous child's exit, or 0
+    uint64_t launch_ns = 0;     // ready -> first child, plus gaps between children
+  };
+
+  JobResult job(const std::string& slug, unsigned width, const std::vector<size_t>& cores, Timing& timing) {
+    JobResult r;
+    r.slug = slug;
+    Placement where = opts_.balancer ? opts_.balancer->acquire() : Placement{};
+    r.node = where.node;
+    where.width = width;
+    for (size_t c : cores) where.cpus += (where.cpus.empty() ? "" : ",") + std::to_string(cores_[c]);
+    bool built = false;
+    PhaseResult last;
+    for (;;) {
+      ++r.attempts;
+      r.failed_phase.clear();
+      if (!built) {
+        last = phase(slug, "build", r.attempts, where, timing);
+        if (last.status == 0) built = true;
+        else r.failed_phase = "build";
+      }
+      if (built) {
+        last = phase(slug, "run", r.attempts, where, timing);
+        if (last.status != 0) r.failed_phase = "run";
+      }
+      if (last.status == 0 || !may_retry(r.attempts)) break;
+    }
+    if (opts_.balancer) opts_.balancer->release(where);
+
+    r.status = last.status;
+    r.line = last_clean_line(r.status == 0 ? last.out : last.err);
+    if (r.line.empty()) r.line = last_clean_line(r.status == 0 ? last.err : last.out);
+    r.out = std::move(last.out);
+    r.err = std::move(last.err);
+    return r;
+  }
+
+  PhaseResult phase(const std::string& slug, const char* name, int attempt, const Placement& where,
+                    Timing& timing) {
+    const auto t0 = std::chrono::steady_clock::now();
+    PhaseResult res = backend_.run(slug, name, where);
+    if (res.spawned_ns) {
+      const uint64_t since = timing.last_exit_ns ? timing.last_exit_ns : timing.ready_ns;
+      if (res.spawned_ns > since) timing.launch_ns += res.spawned_ns - since;
+      timing.last_exit_ns = res.exited_ns;
+    }
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    if (opts_.logs) opts_.logs->add(slug, name, attempt, res.status, res.out, res.err);
+    if (history_.is_open()) {
+      char cpu[32] = "-", peak[32] = "-";
+      if (res.cpu_s >= 0) std::snprintf(cpu, sizeof(cpu), "%.3f", res.cpu_s);
+      if (res.peak_mb >= 0) std::snprintf(peak, sizeof(peak), "%.1f", res.peak_mb);
+      char line[512];
+      std::snprintf(line, sizeof(line), "%s\t%s\t%d\t%s\t%d\t%.3f\t%s\t%s\t%s\n", opts_.sweep_id.c_str(),
+                    slug.c_str(), attempt, name, res.status, secs,
+                    where.node < 0 ? "-" : std::to_string(where.node).c_str(), cpu, peak);
+      std::lock_guard<std::mutex> lock(history_mu_);
+      history_ << line << std::flush;
+    }
+    return res;
+  }
+
+  bool may_retry(int attempt) {
+    if (attempt > opts_.retries) return false;
+    if (opts_.retry_budget < 0) return true;
+    int used = retries_used_.load();
+    do {
+      if (used >= opts_.retry_budget) return false;
+    } while (!retries_used_.compare_exchange_weak(used, used + 1));
+    return true;
+  }
+
+  const std::vector<std::string>& slugs_;
+  SweepBackend& backend_;
+  const SweepOptions& opts_;
+  const std::function<void(const JobResult&)>& on_done_;
+  SweepOverhead* overhead_;
+
+  std::mutex queue_mu_;
+  std::condition_variable room_;
+  std::vector<bool> taken_ = std::vector<bool>(slugs_.size());
+  size_t first_ = 0;     // no job before this one is left to start
+  std::vector<int> cores_;         // CPUs this process may use
+  std::vector<bool> core_busy_;    // held by a parallel job
+  size_t running_ = 0;
+  Resources used_;       // reserved by the jobs in flight
+  std::atomic<size_t> failures_{0};
+  std::atomic<int> retries_used_{0};
+  std::mutex done_mu_;
+  std::mutex history_mu_;
+  std::ofstream history_;
+};
+
+}  // namespace
+
+size_t run_sweep(const std::vector<std::string>& slugs, SweepBackend& backend, const SweepOptions& opts,
+                 const std::function<void(const JobResult&)>& on_done, SweepOverhead* overhead) {
+  return Sweep(slugs, backend, opts, on_done, overhead).run();
+}
+
+}  // namespace polyglot
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "logs.hpp"
+#include "numa.hpp"
+#include "resources.hpp"
+
+namespace polyglot {
+
+// ---- concurrent sweeps ----
+//
+// run_all.sh --jobs N hands the job loop to `polyglot sweep`, which runs build then
+// run for each slug on N worker threads. The scheduler is independent of how a phase
+// is executed: the dispatcher plugs in a Docker backend.
+
+struct PhaseResult {
+  int status = 0;
+  std::string out;
+  std::string err;
+  // When the child process was started and reaped (stats::now_ns clock), for the
+  // runner's overhead accounting; 0 when the backend has no child process.
+  uint64_t spawned_ns = 0;
+  uint64_t exited_ns = 0;
+  // What the phase's container used (CPU seconds, peak MiB); negative when unknown.
+  double cpu_s = -1;
+  double peak_mb = -1;
+};
+
+// Spawns argv (PATH lookup) with stdin fed from `input`, or /dev/null when null, and
+// stdout/stderr captured. Output goes through unlinked temp files rather than pipes,
+// so a chatty build can't block on a full pipe while we wait. Status 127 if the
+// program can't be started, 128+N if killed by signal N.
+PhaseResult spawn_phase(const std::vector<std::string>& args, const std::string* input);
+
+class SweepBackend {
+ public:
+  virtual ~SweepBackend() = default;
+  // Runs one phase ("build" or "run") of a slug with output captured. Called from
+  // several worker threads at once.
+  virtual PhaseResult run(const std::string& slug, const std::string& phase, const Placement& placement) = 0;
+};
+
+struct SweepOptions {
+  unsigned jobs = 1;
+  int retries = 0;                    // extra attempts per job, as run_all.sh --retries
+  int retry_budget = -1;              // total extra attempts per sweep; < 0 is unlimited
+  bool fail_fast = false;             // start no new job after a failure
+  std::set<std::string> non_blocking; // quarantined slugs: their failures stop nothing and aren't counted
+  std::string sweep_id;
+  std::filesystem::path history;      // history.tsv to append to; empty to skip
+  NodeBalancer* balancer = nullptr;   // NUMA placement; null leaves jobs unplaced
+  LogArchive* logs = nullptr;         // where every phase's full output goes; null drops it
+  // Admission: with a non-zero capacity, a job starts only once its request fits next
+  // to those in flight (first fit in sweep order). A job bigger than the host runs
+  // alone. `requests` holds what resource_request() made of each slug; slugs missing
+  // from it reserve the small class. A parallel job (width > 0) is told its width
+  // through Placement::width and, unless NUMA-placed, gets that many cores of its own.
+  Resources capacity;
+  std::map<std::string, Resources> requests;
+};
+
+struct JobResult {
+  std::string slug;
+  int status = 0;
+  std::string failed_phase;  // empty when the job passed
+  int attempts = 0;
+  int node = -1;             // NUMA node the job ran on, -1 if unplaced
+  std::string line;          // hello line on success, else a hint from the failing phase
+  std::string out;           // output of the last phase run
+  std::string err;
+};
+
+// What the runner itself cost, over a sweep. Latencies are per job: "launch" runs from
+// a worker taking the job to its first child starting, plus the gap between its
+// build and run children; "record" from the last child exiting to its result being
+// written to history and reported. cpu is the worker thread's own CPU time for the
+// job (getrusage RUSAGE_THREAD; children not included).
+struct SweepOverhead {
+  size_t jobs = 0;
+  std::vector<double> cpu_us;
+  std::vector<double> launch_us;
+  std::vector<double> record_us;
+  double process_cpu_us = 0;  // the whole runner process, main thread included
+
+  // "cpu 85 us/job, launch p50 410 us p95 900 us, record p50 30 us p95 60 us, ..."
+  std::string summary() const;
+};
+
+// Runs every slug, keeping up to opts.jobs in flight (and within opts.capacity) and
+// starting them in the given order where they fit. Build happens once; if only the run phase fails, retries reuse the image.
+// Each phase attempt is appended to the history store as
+//   sweep_id  slug  attempt  phase  exit  seconds  node  cpu_s  peak_mb
+// (the last two "-" when the backend couldn't measure the container).
+// on_done is called once per finished job, in completion order, never concurrently.
+// Returns the number of failed jobs, not counting non-blocking ones.
+// With `overhead`, the runner's own costs are measured into it.
+size_t run_sweep(const std::vector<std::string>& slugs, SweepBackend& backend, const SweepOptions& opts,
+                 const std::function<void(const JobResult&)>& on_done, SweepOverhead* overhead = nullptr);
+
+// Last non-blank line of program output with CRs and ANSI escapes removed.
+std::string last_clean_line(const std::string& text);
+
+}  // namespace polyglot
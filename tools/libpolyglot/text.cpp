@@ -0,0 +1,310 @@
+#include "text.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <sstream>
+
+namespace polyglot {
+
+std::vector<std::string> split_tabs(const std::string& s) {
+  std::vector<std::string> out;
+  std::string cur;
+  for (char c : s) {
+    if (c == '\t') { out.push_back(cur); cur.clear(); }
+    else { cur.push_back(c); }
+  }
+  out.push_back(cur);
+  return out;
+}
+
+std::string trim(std::string s) {
+  auto notspace = [](unsigned char ch) { return !std::isspace(ch); };
+  s.erase(s.begin(), std::find_if(s.begin(), s.end(), notspace));
+  s.erase(std::find_if(s.rbegin(), s.rend(), notspace).base(), s.end());
+  return s;
+}
+
+std::string lower(std::string s) {
+  std::transform(s.begin(), s.end(), s.begin(),
+                 [](unsigned char c) { return (char)std::tolower(c); });
+  return s;
+}
+
+// Unescape TSV fields (supports \n \t \r \\ \" \')
+std::string unescape(const std::string& s) {
+  std::string out;
+  out.reserve(s.size());
+  for (size_t i = 0; i < s.size(); ++i) {
+    if (s[i] == '\\' && i + 1 < s.size()) {
+      char n = s[i + 1];
+      if (n == 'n')  { out.push_back('\n'); ++i; continue; }
+      if (n == 't')  { out.push_back('\t'); ++i; continue; }
+      if (n == 'r')  { out.push_back('\r'); ++i; continue; }
+      if (n == '\\') { out.push_back('\\'); ++i; continue; }
+      if (n == '"')  { out.push_back('"');  ++i; continue; }
+      if (n == '\'') { out.push_back('\''); ++i; continue; }
+    }
+    out.push_back(s[i]);
+  }
+  return out;
+}
+
+std::string strip_utf8_bom(std::string s) {
+  // UTF-8 BOM: EF BB BF
+  if (s.size() >= 3 &&
+      (unsigned char)s[0] == 0xEF &&
+      (unsigned char)s[1] == 0xBB &&
+      (unsigned char)s[2] == 0xBF) {
+    s.erase(0, 3);
+  }
+  return s;
+}
+
+bool ends_with_nl(const std::string& s) {
+  return !s.empty() && (s.back() == '\n');
+}
+
+// Docker exec-form CMD is JSON. Escape so generated Dockerfile is always valid JSON.
+std::string json_escape(const std::string& s) {
+  std::string out;
+  out.reserve(s.size() + 8);
+  for (unsigned char c : s) {
+    switch (c) {
+      case '\\': out += "\\\\"; break;
+      case '"':  out += "\\\""; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if (c < 0x20) {
+          std::ostringstream oss;
+          oss << "\\u" << std::hex << std::uppercase
+              << std::setw(4) << std::setfill('0') << (int)c;
+          out += oss.str();
+        } else {
+          out.push_back((char)c);
+        }
+    }
+  }
+  return out;
+}
+
+bool ends_with(const std::string& s, const std::string& suf) {
+  return s.size() >= suf.size() && s.compare(s.size() - suf.size(), suf.size(), suf) == 0;
+}
+
+std::string file_ext(const std::string& s) {
+  auto pos = s.rfind('.');
+  if (pos == std::string::npos) return "";
+  return s.substr(pos); // includes '.'
+}
+
+std::string strip_trailing_punct(std::string t) {
+  while (!t.empty()) {
+    char c = t.back();
+    if (c == ';' || c == ',' || c == ')' || c == ']' || c == '\r' || c == '\n') t.pop_back();
+    else break;
+  }
+  return t;
+}
+
+static bool is_blank(char c) { return c == ' ' || c == '\t'; }
+
+static bool is_operator(char c) {
+  return c == ';' || c == '&' || c == '|' || c == '(' || c == ')' || c == '<' || c == '>';
+}
+
+bool ShellLexer::next(ShellWord& w) {
+  const size_t n = s_.size();
+  for (;;) {
+    while (pos_ < n) {
+      if (is_blank(s_[pos_])) ++pos_;
+      else if (s_[pos_] == '\\' && pos_ + 1 < n && s_[pos_ + 1] == '\n') pos_ += 2;  // line continuation
+      else break;
+    }
+    if (pos_ >= n) return false;
+
+    const char c = s_[pos_];
+    if (c == '\n') {
+      ++pos_;
+      skip_heredoc_bodies();
+      continue;
+    }
+    if (c == '#') {
+      while (pos_ < n && s_[pos_] != '\n') ++pos_;
+      continue;
+    }
+    if (is_operator(c)) {
+      // "<<" and "<<-" introduce a here-document; "<<<" is a here-string.
+      if (c == '<' && pos_ + 1 < n && s_[pos_ + 1] == '<' && (pos_ + 2 >= n || s_[pos_ + 2] != '<')) {
+        pos_ += 2;
+        strip_tabs_ = pos_ < n && s_[pos_] == '-';
+        if (strip_tabs_) ++pos_;
+        want_delim_ = true;
+        continue;
+      }
+      while (pos_ < n && s_[pos_] == c) ++pos_;
+      continue;
+    }
+
+    const size_t start = pos_;
+    bool quoted = false;
+    while (pos_ < n) {
+      const char ch = s_[pos_];
+      if (ch == '\\') {
+        quoted = true;
+        pos_ = std::min(pos_ + 2, n);
+      } else if (ch == '\'') {
+        quoted = true;
+        const size_t close = s_.find('\'', pos_ + 1);
+        pos_ = close == std::string_view::npos ? n : close + 1;
+      } else if (ch == '"') {
+        quoted = true;
+        ++pos_;
+        while (pos_ < n && s_[pos_] != '"') pos_ += (s_[pos_] == '\\') ? 2 : 1;
+        pos_ = std::min(pos_ + 1, n);
+      } else if (is_blank(ch) || ch == '\n' || is_operator(ch)) {
+        break;
+      } else {
+        ++pos_;
+      }
+    }
+
+    const std::string_view raw = s_.substr(start, pos_ - start);
+    if (want_delim_) {
+      want_delim_ = false;
+      if (heredoc_count_ < kMaxHeredocs) heredocs_[heredoc_count_++] = {raw, strip_tabs_};
+      continue;  // the delimiter is not an argument
+    }
+    w.raw = raw;
+    w.quoted = quoted;
+    return true;
+  }
+}
+
+// True if `line` equals the value of the raw delimiter word (quote characters and
+// backslashes in the delimiter don't count, which is how the shell reads it).
+static bool is_delimiter_line(std::string_view line, std::string_view delim) {
+  size_t i = 0;
+  for (char c : delim) {
+    if (c == '\'' || c == '"' || c == '\\') continue;
+    if (i >= line.size() || line[i] != c) return false;
+    ++i;
+  }
+  return i == line.size();
+}
+
+// Called just past a newline: consumes the bodies of pending here-documents, in order.
+void ShellLexer::skip_heredoc_bodies() {
+  const size_t n = s_.size();
+  for (size_t h = 0; h < heredoc_count_; ++h) {
+    while (pos_ < n) {
+      size_t eol = s_.find('\n', pos_);
+      if (eol == std::string_view::npos) eol = n;
+      std::string_view line = s_.substr(pos_, eol - pos_);
+      if (heredocs_[h].strip_tabs) {
+        while (!line.empty() && line.front() == '\t') line.remove_prefix(1);
+      }
+      pos_ = std::min(eol + 1, n);
+      if (is_delimiter_line(line, heredocs_[h].delim)) break;
+    }
+  }
+  heredoc_count_ = 0;
+}
+
+void ShellLexer::unquote(std::string_view raw, std::string& out) {
+  const size_t n = raw.size();
+  for (size_t i = 0; i < n; ++i) {
+    const char c = raw[i];
+    if (c == '\\') {
+      if (i + 1 < n && raw[i + 1] != '\n') out.push_back(raw[i + 1]);
+      ++i;
+    } else if (c == '\'') {
+      while (++i < n && raw[i] != '\'') out.push_back(raw[i]);
+    } else if (c == '"') {
+      while (++i < n && raw[i] != '"') {
+        if (raw[i] == '\\' && i + 1 < n) {
+          const char e = raw[i + 1];
+          if (e == '$' || e == '`' || e == '"' || e == '\\') { out.push_back(e); ++i; continue; }
+          if (e == '\n') { ++i; continue; }
+        }
+        out.push_back(raw[i]);
+      }
+    } else {
+      out.push_back(c);
+    }
+  }
+}
+
+std::vector<std::string> shellish_split(const std::string& s) {
+  std::vector<std::string> out;
+  ShellLexer lex(s);
+  ShellWord w;
+  while (lex.next(w)) {
+    if (w.quoted) {
+      out.emplace_back();
+      ShellLexer::unquote(w.raw, out.back());
+    } else {
+      out.emplace_back(w.raw);
+    }
+  }
+  return out;
+}
+
+static std::string_view leaf_name(std::string_view p) {
+  const size_t slash = p.rfind('/');
+  return slash == std::string_view::npos ? p : p.substr(slash + 1);
+}
+
+std::string normalize_filename(const std::string& tok) {
+  return std::string(leaf_name(tok));
+}
+
+std::string find_last_file_ref(const std::string& cmd, const std::string& ext) {
+  if (cmd.empty() || ext.empty()) return "";
+  std::string last;
+  std::string scratch;  // only used for quoted words
+  ShellLexer lex(cmd);
+  ShellWord w;
+  while (lex.next(w)) {
+    std::string_view v = w.raw;
+    if (w.quoted) {
+      scratch.clear();
+      ShellLexer::unquote(w.raw, scratch);
+      v = scratch;
+    }
+    while (!v.empty() && (v.back() == ',' || v.back() == ']' || v.back() == '\r')) v.remove_suffix(1);
+    const std::string_view leaf = leaf_name(v);
+    if (leaf.size() >= ext.size() && leaf.compare(leaf.size() - ext.size(), ext.size(), ext) == 0) {
+      last.assign(leaf.data(), leaf.size());
+    }
+  }
+  return last;
+}
+
+bool icontains(const std::string& hay, const std::string& needle) {
+  auto h = lower(hay);
+  auto n = lower(needle);
+  return h.find(n) != std::string::npos;
+}
+
+void replace_all(std::string& s, const std::string& from, const std::string& to) {
+  if (from.empty()) return;
+  size_t pos = 0;
+  while ((pos = s.find(from, pos)) != std::string::npos) {
+    s.replace(pos, from.size(), to);
+    pos += to.size();
+  }
+}
+
+std::string shell_quote(const std::string& s) {
+  std::string out = "'";
+  for (char c : s) {
+    if (c == '\'') out += "'\\''";
+    else out.push_back(c);
+  }
+  return out + "'";
+}
+
+}  // namespace polyglot
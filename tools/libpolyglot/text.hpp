@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// String helpers shared by the manifest parser, renderer and tools.
+namespace polyglot {
+
+std::vector<std::string> split_tabs(const std::string& s);
+std::string trim(std::string s);
+std::string lower(std::string s);
+
+// Unescape TSV fields (supports \n \t \r \\ \" \')
+std::string unescape(const std::string& s);
+std::string strip_utf8_bom(std::string s);
+bool ends_with_nl(const std::string& s);
+
+// Docker exec-form CMD is JSON. Escape so generated Dockerfile is always valid JSON.
+std::string json_escape(const std::string& s);
+
+bool ends_with(const std::string& s, const std::string& suf);
+std::string file_ext(const std::string& s); // includes '.'
+std::string strip_trailing_punct(std::string t);
+
+// One word of a shell command, as a span of the command text. `quoted` is set when
+// the word contains quotes or backslashes, i.e. when its value differs from `raw`.
+struct ShellWord {
+  std::string_view raw;
+  bool quoted = false;
+};
+
+// Single-pass, non-allocating lexer for the POSIX shell subset our commands use:
+// blanks, newlines and the operators ; & | ( ) < > separate words; single quotes,
+// double quotes (with their backslash rules) and backslash escapes are honoured;
+// '#' at the start of a word comments to end of line; here-document bodies are
+// skipped. Parameter expansion and the like are left as literal text.
+class ShellLexer {
+ public:
+  explicit ShellLexer(std::string_view s) : s_(s) {}
+
+  // Advances to the next word; false at end of input.
+  bool next(ShellWord& w);
+
+  // Appends the value of a word (quotes removed, escapes resolved) to out.
+  static void unquote(std::string_view raw, std::string& out);
+
+ private:
+  static constexpr size_t kMaxHeredocs = 8;
+  struct Heredoc {
+    std::string_view delim;  // raw delimiter word, quotes included
+    bool strip_tabs;         // <<-
+  };
+
+  void skip_heredoc_bodies();
+
+  std::string_view s_;
+  size_t pos_ = 0;
+  bool want_delim_ = false;
+  bool strip_tabs_ = false;
+  Heredoc heredocs_[kMaxHeredocs];
+  size_t heredoc_count_ = 0;
+};
+
+// Words of a shell command with quoting removed (see ShellLexer).
+std::vector<std::string> shellish_split(const std::string& s);
+std::string normalize_filename(const std::string& tok);
+
+// Last word in a shell command naming a file with extension `ext` (leaf name only).
+// One pass over the command; only the match itself (and quoted words) are copied.
+std::string find_last_file_ref(const std::string& cmd, const std::string& ext);
+
+bool icontains(const std::string& hay, const std::string& needle);
+void replace_all(std::string& s, const std::string& from, const std::string& to);
+
+// Single-quotes s for /bin/sh.
+std::string shell_quote(const std::string& s);
+
+}  // namespace polyglot
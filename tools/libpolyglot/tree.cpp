@@ -0,0 +1,227 @@
+#include "tree.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_set>
+
+#include "stats.hpp"
+#include "text.hpp"
+
+namespace polyglot {
+
+std::string read_file_or_empty(const fs::path& p) {
+  std::ifstream f(p, std::ios::binary);
+  if (!f) return "";
+  std::ostringstream oss;
+  oss << f.rdbuf();
+  std::string s = oss.str();
+  stats::add(stats::kBytesRead, s.size());
+  return s;
+}
+
+bool write_file_if_changed(const fs::path& p, const std::string& content) {
+  std::string existing = read_file_or_empty(p);
+  if (!existing.empty() && existing == content) {
+    stats::add(stats::kFilesUnchanged, 1);
+    return false;
+  }
+
+  std::ofstream f(p, std::ios::binary);
+  if (!f) throw std::runtime_error("Failed to write: " + p.string());
+  f << content;
+  stats::add(stats::kFilesWritten, 1);
+  stats::add(stats::kBytesWritten, content.size());
+  return true;
+}
+
+// Keep --force semantics for people who want to blast everything,
+// but the default behavior now still updates when content differs.
+static bool write_file(const fs::path& p, const std::string& content, bool force) {
+  stats::Probe probe(stats::kWriteFile);
+  if (force) {
+    std::ofstream f(p, std::ios::binary);
+    if (!f) throw std::runtime_error("Failed to write: " + p.string());
+    f << content;
+    stats::add(stats::kFilesWritten, 1);
+    stats::add(stats::kBytesWritten, content.size());
+    return true;
+  }
+  return write_file_if_changed(p, content);
+}
+
+static void remove_quiet(const fs::path& p) {
+  std::error_code ec;
+  fs::remove(p, ec);
+}
+
+static void remove_case_insensitive_conflicts(const fs::path& dir, const std::string& target) {
+  stats::Probe probe(stats::kConflictRemoval);
+  std::error_code ec;
+  if (!fs::exists(dir, ec)) return;
+
+  const std::string target_l = lower(target);
+  for (const auto& entry : fs::directory_iterator(dir, ec)) {
+    if (ec) break;
+    if (!entry.is_regular_file(ec)) continue;
+    const std::string name = entry.path().filename().string();
+    if (lower(name) == target_l && name != target) {
+      remove_quiet(entry.path());
+    }
+  }
+  remove_quiet(dir / target);
+}
+void write_artifacts(const fs::path& dir, const std::vector<Artifact>& artifacts, bool force) {
+  fs::create_directories(dir);
+  for (const auto& a : artifacts) {
+    if (a.source) {
+      // macOS case-only rename handling:
+      remove_case_insensitive_conflicts(dir, a.name);
+      write_file(dir / a.name, a.content, true /* always write exact-name */);
+    } else {
+      write_file(dir / a.name, a.content, force);
+    }
+    if (a.executable) {
+      stats::Probe probe(stats::kChmod);
+      fs::permissions(dir / a.name,
+                      fs::perms::owner_exec | fs::perms::group_exec | fs::perms::others_exec,
+                      fs::perm_options::add);
+    }
+  }
+}
+
+uint64_t fnv1a(const std::string& s, uint64_t h) {
+  for (unsigned char c : s) {
+    h ^= c;
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+std::string hex64(uint64_t v) {
+  std::ostringstream oss;
+  oss << std::hex << std::setw(16) << std::setfill('0') << v;
+  return oss.str();
+}
+
+MerkleIndex::MerkleIndex(fs::path dir) : dir_(std::move(dir)) {
+  std::error_code ec;
+  for (const auto& entry : fs::directory_iterator(dir_, ec)) {
+    const std::string name = entry.path().filename().string();
+    if (name == "ROOT") continue;
+    std::ifstream f(entry.path());
+    std::string hash;
+    if (std::getline(f, hash) && !hash.empty()) slugs_[name] = hash;
+  }
+  root_ = trim(read_file_or_empty(dir_ / "ROOT"));
+}
+
+void MerkleIndex::update(const std::string& slug, const std::vector<Artifact>& artifacts) {
+  std::vector<std::string> lines;
+  for (const auto& a : artifacts) {
+    lines.push_back(hex64(fnv1a(a.content)) + (a.executable ? " 100755 " : " 100644 ") + a.name);
+  }
+  std::sort(lines.begin(), lines.end(), [](const std::string& x, const std::string& y) {
+    return x.substr(24) < y.substr(24); // by name
+  });
+  std::string body;
+  for (const auto& l : lines) body += l + "\n";
+  const std::string hash = hex64(fnv1a(body));
+
+  auto it = slugs_.find(slug);
+  if (it != slugs_.end() && it->second == hash) return;
+  slugs_[slug] = hash;
+  fs::create_directories(dir_);
+  write_file_if_changed(dir_ / slug, hash + "\n" + body);
+  dirty_ = true;
+}
+
+void MerkleIndex::retain(const std::vector<std::string>& slugs) {
+  const std::unordered_set<std::string> keep(slugs.begin(), slugs.end());
+  for (auto it = slugs_.begin(); it != slugs_.end();) {
+    if (keep.count(it->first)) {
+      ++it;
+      continue;
+    }
+    std::error_code ec;
+    fs::remove(dir_ / it->first, ec);
+    it = slugs_.erase(it);
+    dirty_ = true;
+  }
+}
+
+const std::string& MerkleIndex::save() {
+  if (!dirty_ && !root_.empty()) return root_;
+  std::map<std::string, std::string> sorted(slugs_.begin(), slugs_.end());
+  std::string all;
+  for (const auto& [slug, hash] : sorted) all += slug + "\t" + hash + "\n";
+  root_ = hex64(fnv1a(all));
+  fs::create_directories(dir_);
+  write_file_if_changed(dir_ / "ROOT", root_ + "\n");
+  dirty_ = false;
+  return root_;
+}
+
+// ---- check: compare what scaffold would write against what is on disk ----
+
+std::vector<SlugDrift> check_tree(const Manifest& manifest, const fs::path& languages_dir) {
+  std::vector<SlugDrift> drift;
+  for (const auto& slug : manifest.slugs()) {
+    SlugDrift d;
+    d.slug = slug;
+    const fs::path dir = languages_dir / slug;
+
+    // Exact names from the directory listing, so case-only differences show up even
+    // on case-insensitive filesystems.
+    std::unordered_map<std::string, fs::directory_entry> on_disk;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+      const std::string name = entry.path().filename().string();
+      if (name != ".DS_Store") on_disk[name] = entry;
+    }
+
+    for (const auto& a : render(*manifest.find(slug))) {
+      auto it = on_disk.find(a.name);
+      if (it == on_disk.end()) { d.added.push_back(a.name); continue; }
+      const fs::directory_entry entry = it->second;
+      on_disk.erase(it);
+
+      // Size first; only same-size files are read and compared.
+      const auto size = entry.file_size(ec);
+      bool differs = ec || size != a.content.size() || read_file_or_empty(entry.path()) != a.content;
+      if (a.executable) {
+        const auto perms = entry.status(ec).permissions();
+        if ((perms & fs::perms::owner_exec) == fs::perms::none) differs = true;
+      }
+      if (differs) d.changed.push_back(a.name);
+    }
+    for (const auto& [name, entry] : on_disk) d.removed.push_back(name);
+    std::sort(d.removed.begin(), d.removed.end());
+
+    if (!d.added.empty() || !d.changed.empty() || !d.removed.empty()) drift.push_back(std::move(d));
+  }
+
+  // Generated directories whose rows are gone.
+  std::error_code ec;
+  std::vector<std::string> stale;
+  for (const auto& entry : fs::directory_iterator(languages_dir, ec)) {
+    const std::string name = entry.path().filename().string();
+    if (entry.is_directory(ec) && !manifest.find(name)) stale.push_back(name);
+  }
+  std::sort(stale.begin(), stale.end());
+  for (const auto& slug : stale) {
+    SlugDrift d;
+    d.slug = slug;
+    for (const auto& entry : fs::directory_iterator(languages_dir / slug, ec)) {
+      d.removed.push_back(entry.path().filename().string());
+    }
+    std::sort(d.removed.begin(), d.removed.end());
+    drift.push_back(std::move(d));
+  }
+  return drift;
+}
+
+}  // namespace polyglot
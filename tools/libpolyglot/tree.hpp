@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "manifest.hpp"
+#include "render.hpp"
+
+namespace polyglot {
+
+namespace fs = std::filesystem;
+
+std::string read_file_or_empty(const fs::path& p);
+// Writes if missing OR content differs (durable; avoids needing --force).
+bool write_file_if_changed(const fs::path& p, const std::string& content);
+
+// Writes one language's artifacts into dir (creating it), fixing up case-only
+// renames of the source file and the exec bit on run.sh.
+void write_artifacts(const fs::path& dir, const std::vector<Artifact>& artifacts, bool force);
+
+uint64_t fnv1a(const std::string& s, uint64_t h = 14695981039346656037ull);
+std::string hex64(uint64_t v);
+
+// ---- Merkle index of the generated tree ----
+//
+// .polyglot/merkle/<slug> holds the slug's subtree hash on its first line, then one
+// "<content-hash> <mode> <name>" line per generated file. .polyglot/merkle/ROOT hashes
+// the sorted (slug, subtree hash) pairs. Hashes are computed from the rendered content
+// as rows are written, so updating the index costs O(changed rows), never a re-read of
+// languages/. FNV-1a 64 is plenty to detect change; this is not a security boundary.
+class MerkleIndex {
+ public:
+  explicit MerkleIndex(fs::path dir);
+
+  // Records a slug's freshly rendered artifacts; rewrites its entry only if it changed.
+  void update(const std::string& slug, const std::vector<Artifact>& artifacts);
+
+  // Drops entries (and their files) for slugs no longer in the manifest, so ROOT
+  // covers exactly the current rows.
+  void retain(const std::vector<std::string>& slugs);
+
+  // Recomputes the root from subtree hashes (not file contents) and persists it.
+  const std::string& save();
+
+ private:
+  fs::path dir_;
+  std::unordered_map<std::string, std::string> slugs_;
+  std::string root_;
+  bool dirty_ = false;
+};
+
+// ---- check: compare what scaffold would write against what is on disk ----
+
+struct SlugDrift {
+  std::string slug;
+  std::vector<std::string> added, changed, removed;
+};
+
+std::vector<SlugDrift> check_tree(const Manifest& manifest, const fs::path& languages_dir);
+
+}  // namespace polyglot
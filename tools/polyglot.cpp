@@ -0,0 +1,1006 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "libpolyglot/polyglot.hpp"
+#ifdef POLYGLOT_EMBEDDED_REGISTRY
+#include "libpolyglot/registry.gen.hpp"
+#endif
+
+extern char** environ;
+
+namespace fs = std::filesystem;
+
+// polyglot: build and run one language's container directly, without the bash
+// run.sh hop. Image naming, build context and POLYGLOT_PLATFORM handling match
+// what scaffold's run.sh template does.
+
+// Repo root: $POLYGLOT_ROOT, else the nearest ancestor of cwd holding languages.tsv
+// (run.sh shims call us from languages/<slug>/).
+static fs::path find_root() {
+  if (const char* env = std::getenv("POLYGLOT_ROOT")) return env;
+  std::error_code ec;
+  for (fs::path p = fs::current_path(); !p.empty(); p = p.parent_path()) {
+    if (fs::exists(p / "languages.tsv", ec)) return p;
+    if (p == p.parent_path()) break;
+  }
+  throw std::runtime_error("Cannot find languages.tsv (set POLYGLOT_ROOT)");
+}
+
+// Spawns argv (PATH lookup, inherited stdio) and returns its exit status.
+static int spawn_wait(const std::vector<std::string>& args) {
+  std::vector<char*> argv;
+  for (const auto& a : args) argv.push_back(const_cast<char*>(a.c_str()));
+  argv.push_back(nullptr);
+
+  pid_t pid;
+  int rc = posix_spawnp(&pid, argv[0], nullptr, nullptr, argv.data(), environ);
+  if (rc != 0) {
+    std::cerr << "Failed to start " << args[0] << ": " << std::strerror(rc) << "\n";
+    return 127;
+  }
+  int status = 0;
+  while (waitpid(pid, &status, 0) < 0) {
+    if (errno != EINTR) return 127;
+  }
+  if (WIFEXITED(status)) return WEXITSTATUS(status);
+  if (WIFSIGNALED(status)) return 128 + WTERMSIG(status);
+  return 1;
+}
+
+// Like spawn_wait, but feeds `input` to the child's stdin.
+static int spawn_wait_input(const std::vector<std::string>& args, const std::string& input) {
+  std::vector<char*> argv;
+  for (const auto& a : args) argv.push_back(const_cast<char*>(a.c_str()));
+  argv.push_back(nullptr);
+
+  int pipefd[2];
+  if (::pipe(pipefd) != 0) return 127;
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_adddup2(&actions, pipefd[0], 0);
+  posix_spawn_file_actions_addclose(&actions, pipefd[0]);
+  posix_spawn_file_actions_addclose(&actions, pipefd[1]);
+
+  pid_t pid;
+  int rc = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+  posix_spawn_file_actions_destroy(&actions);
+  ::close(pipefd[0]);
+  if (rc != 0) {
+    ::close(pipefd[1]);
+    std::cerr << "Failed to start " << args[0] << ": " << std::strerror(rc) << "\n";
+    return 127;
+  }
+
+  // A child that exits early just closes the pipe; treat EPIPE as end of input.
+  std::signal(SIGPIPE, SIG_IGN);
+  for (size_t off = 0; off < input.size();) {
+    ssize_t w = ::write(pipefd[1], input.data() + off, input.size() - off);
+    if (w < 0 && errno == EINTR) continue;
+    if (w < 0) break;
+    off += (size_t)w;
+  }
+  ::close(pipefd[1]);
+
+  int status = 0;
+  while (waitpid(pid, &status, 0) < 0) {
+    if (errno != EINTR) return 127;
+  }
+  if (WIFEXITED(status)) return WEXITSTATUS(status);
+  if (WIFSIGNALED(status)) return 128 + WTERMSIG(status);
+  return 1;
+}
+
+static std::vector<std::string> platform_args() {
+  const char* p = std::getenv("POLYGLOT_PLATFORM");
+  if (p && *p) return {"--platform", p};
+  return {};
+}
+
+// $POLYGLOT_ARCHIVE: a scaffold --output-archive tar[.zst] to take build contexts
+// (and the list of languages) from instead of languages/.
+static const char* archive_path() {
+  const char* p = std::getenv("POLYGLOT_ARCHIVE");
+  return p && *p ? p : nullptr;
+}
+
+// $POLYGLOT_BUILD_CACHE: a directory holding a local BuildKit cache per slug (see
+// buildcache.hpp) that builds import from and export to.
+static const char* build_cache_dir() {
+  const char* p = std::getenv("POLYGLOT_BUILD_CACHE");
+  return p && *p ? p : nullptr;
+}
+
+// $POLYGLOT_PROXY: URL of a running `polyglot proxy`, passed to builds as http_proxy
+// (a predefined build arg, so it doesn't enter the cache key). A loopback proxy is
+// only reachable from RUN steps on the host network, which a docker-container builder
+// (what POLYGLOT_BUILD_CACHE needs) refuses without the network.host entitlement.
+static std::vector<std::string> proxy_args() {
+  const char* url = std::getenv("POLYGLOT_PROXY");
+  if (!url || !*url) return {};
+  std::vector<std::string> args = {"--build-arg", std::string("http_proxy=") + url, "--build-arg",
+                                   std::string("HTTP_PROXY=") + url};
+  const std::string u = url;
+  for (const char* loopback : {"//127.", "//localhost", "//[::1]"}) {
+    if (u.find(loopback) == std::string::npos) continue;
+    if (build_cache_dir()) {
+      throw std::runtime_error("POLYGLOT_PROXY " + u +
+                               " is loopback, which builds only reach on the host network; a docker-container "
+                               "builder (POLYGLOT_BUILD_CACHE) doesn't allow that. Listen on an address the build "
+                               "containers reach, e.g. the bridge gateway 172.17.0.1:3142");
+    }
+    args.insert(args.end(), {"--network", "host"});
+    break;
+  }
+  return args;
+}
+
+// `docker build` argv for a slug; from an archive the context is "-" (stdin). `jobs`
+// overrides the POLYGLOT_JOBS build arg of a row that declares a width.
+static std::vector<std::string> build_args(const fs::path& root, const std::string& slug, unsigned jobs = 0) {
+  std::vector<std::string> args = {"docker", "build"};
+  for (auto& a : platform_args()) args.push_back(a);
+  if (jobs) args.insert(args.end(), {"--build-arg", "POLYGLOT_JOBS=" + std::to_string(jobs)});
+  if (const char* cache = build_cache_dir()) {
+    for (auto& a : polyglot::build_cache_args(cache, slug)) args.push_back(a);
+  }
+  for (auto& a : proxy_args()) args.push_back(a);
+  args.insert(args.end(), {"-t", "hello-" + slug});
+  args.push_back(archive_path() ? "-" : (root / "languages" / slug).string());
+  return args;
+}
+
+// `entries` is the parsed $POLYGLOT_ARCHIVE (see Languages), read once per process.
+static int docker_build(const fs::path& root, const std::string& slug,
+                        const std::vector<polyglot::TarEntry>& entries) {
+  if (archive_path()) return spawn_wait_input(build_args(root, slug), polyglot::build_context(entries, slug));
+  return spawn_wait(build_args(root, slug));
+}
+
+// `docker run` argv; `limits` are the row's declared resources, enforced as --cpus and
+// --memory, and a placement's width is passed on as width_env.
+static std::vector<std::string> run_args(const std::string& slug, const polyglot::LaunchProfile& profile,
+                                         const polyglot::Placement& placement = {},
+                                         const polyglot::Resources& limits = {}) {
+  std::vector<std::string> args = {"docker", "run", "--rm"};
+  for (auto& a : platform_args()) args.push_back(a);
+  for (auto& a : polyglot::launch_args(profile)) args.push_back(a);
+  for (auto& a : polyglot::placement_args(placement)) args.push_back(a);
+  for (auto& a : polyglot::resource_args(limits)) args.push_back(a);
+  for (auto& a : polyglot::width_args(placement.width)) args.push_back(a);
+  args.push_back("hello-" + slug);
+  return args;
+}
+
+// $POLYGLOT_PROFILE picks how run-phase containers are launched (default or lean).
+static int docker_run(const std::string& slug, const polyglot::Resources& limits) {
+  const char* name = std::getenv("POLYGLOT_PROFILE");
+  polyglot::Placement placement;
+  placement.width = std::min(limits.width, (unsigned)polyglot::host_capacity().cpus);
+  return spawn_wait(run_args(slug, polyglot::LaunchProfile::named(name ? name : ""), placement, limits));
+}
+
+// Spawns argv with stdout/stderr sent to /dev/null; returns its exit status.
+static int spawn_quiet(const std::vector<std::string>& args) {
+  std::vector<char*> argv;
+  for (const auto& a : args) argv.push_back(const_cast<char*>(a.c_str()));
+  argv.push_back(nullptr);
+
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_addopen(&actions, 1, "/dev/null", O_WRONLY, 0);
+  posix_spawn_file_actions_adddup2(&actions, 1, 2);
+  pid_t pid;
+  int rc = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+  posix_spawn_file_actions_destroy(&actions);
+  if (rc != 0) return 127;
+  int status = 0;
+  while (waitpid(pid, &status, 0) < 0) {
+    if (errno != EINTR) return 127;
+  }
+  return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + (WIFSIGNALED(status) ? WTERMSIG(status) : 0);
+}
+
+// bench-launch: median `docker run` wall time per slug under the default launch,
+// each lean switch on its own (the difference is what that default costs), the
+// full lean profile, and seccomp off for reference. Images must already be built.
+static int bench_launch(const std::vector<std::string>& slugs, int repeat) {
+  struct Variant {
+    const char* name;
+    polyglot::LaunchProfile profile;
+  };
+  std::vector<Variant> variants = {{"default", {}}};
+  polyglot::LaunchProfile p;
+  p.no_network = true;
+  variants.push_back({"net=none", p});
+  p = {};
+  p.no_logs = true;
+  variants.push_back({"log=none", p});
+  p = {};
+  p.read_only = true;
+  variants.push_back({"read-only", p});
+  p = {};
+  p.drop_caps = true;
+  variants.push_back({"cap-drop", p});
+  p = {};
+  p.no_seccomp = true;
+  variants.push_back({"no-seccomp", p});
+  variants.push_back({"lean", polyglot::LaunchProfile::lean()});
+
+  std::printf("%-16s", "slug (ms)");
+  for (const auto& v : variants) std::printf(" %10s", v.name);
+  std::printf("\n");
+
+  int failures = 0;
+  for (const auto& slug : slugs) {
+    std::printf("%-16s", slug.c_str());
+    for (const auto& v : variants) {
+      const auto args = run_args(slug, v.profile);
+      std::vector<double> ms;
+      bool failed = false;
+      for (int r = 0; r < repeat && !failed; ++r) {
+        const auto t0 = std::chrono::steady_clock::now();
+        failed = spawn_quiet(args) != 0;
+        ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+      }
+      if (failed) {
+        std::printf(" %10s", "FAIL");
+        ++failures;
+        continue;
+      }
+      std::sort(ms.begin(), ms.end());
+      std::printf(" %10.1f", ms[ms.size() / 2]);
+    }
+    std::printf("\n");
+    std::fflush(stdout);
+  }
+  return failures ? 1 : 0;
+}
+
+// Sweep backend that does what `polyglot build|run` does, with output captured and
+// the run phase pinned to the job's NUMA placement. Builds execute in the Docker
+// daemon, outside any cpuset we could give the client, so only runs are placed (and
+// limited, and measured: the run container's cgroup is sampled for the history store).
+class DockerBackend : public polyglot::SweepBackend {
+ public:
+  DockerBackend(const fs::path& root, std::map<std::string, polyglot::Resources> limits,
+                const std::vector<polyglot::TarEntry>& entries)
+      : root_(root), limits_(std::move(limits)), entries_(entries) {
+    const char* name = std::getenv("POLYGLOT_PROFILE");
+    profile_ = polyglot::LaunchProfile::named(name ? name : "");
+  }
+
+  polyglot::PhaseResult run(const std::string& slug, const std::string& phase,
+                            const polyglot::Placement& placement) override {
+    if (phase != "build") {
+      const auto it = limits_.find(slug);
+      auto args = run_args(slug, profile_, placement, it == limits_.end() ? polyglot::Resources{} : it->second);
+      const fs::path cidfile = fs::temp_directory_path() /
+                               ("polyglot-" + std::to_string(::getpid()) + "-" + std::to_string(++runs_) + ".cid");
+      args.insert(args.begin() + 3, {"--cidfile", cidfile.string()});
+      polyglot::CgroupSampler sampler(cidfile);
+      polyglot::PhaseResult r = polyglot::spawn_phase(args, nullptr);
+      sampler.stop();
+      r.cpu_s = sampler.cpu_seconds();
+      r.peak_mb = sampler.peak_mb();
+      std::error_code ec;
+      fs::remove(cidfile, ec);
+      return r;
+    }
+    // Only rows that declare a width have the build arg to override.
+    const auto it = limits_.find(slug);
+    const unsigned jobs = it != limits_.end() && it->second.width ? placement.width : 0;
+    if (!archive_path()) return polyglot::spawn_phase(build_args(root_, slug, jobs), nullptr);
+    const std::string context = polyglot::build_context(entries_, slug);
+    return polyglot::spawn_phase(build_args(root_, slug, jobs), &context);
+  }
+
+ private:
+  fs::path root_;
+  std::map<std::string, polyglot::Resources> limits_;
+  polyglot::LaunchProfile profile_;
+  const std::vector<polyglot::TarEntry>& entries_;
+  std::atomic<unsigned> runs_{0};
+};
+
+// Fields of a sweep result line can't hold tabs or newlines.
+static std::string one_field(std::string s) {
+  for (char& c : s) {
+    if (c == '\t' || c == '\n') c = ' ';
+  }
+  return s.empty() ? "-" : s;
+}
+
+// sweep: the parallel job loop behind run_all.sh --jobs. One line per finished job:
+//   slug  exit  failed-phase  attempts  node  hello-or-hint
+// ("-" for empty fields), so the runner can keep its own reporting and summary,
+// then "#overhead<TAB>..." with what the sweep itself cost (SweepOverhead::summary).
+static int sweep(const std::vector<std::string>& slugs, polyglot::SweepOptions opts, bool numa, bool verbose,
+                 polyglot::SweepBackend& backend) {
+  std::optional<polyglot::NodeBalancer> balancer;
+  if (numa) {
+    balancer.emplace(polyglot::numa_nodes());
+    if (balancer->nodes().size() > 1) opts.balancer = &*balancer;
+  }
+  polyglot::SweepOverhead overhead;
+  const size_t failed = polyglot::run_sweep(
+      slugs, backend, opts,
+      [&](const polyglot::JobResult& r) {
+        if (verbose) {
+          std::cerr << "\n---- " << r.slug << " ----\n" << r.out << r.err;
+        }
+        std::cout << r.slug << "\t" << r.status << "\t" << one_field(r.failed_phase) << "\t" << r.attempts << "\t"
+                  << (r.node < 0 ? "-" : std::to_string(r.node)) << "\t" << one_field(r.line) << std::endl;
+      },
+      &overhead);
+  std::cout << "#overhead\t" << overhead.summary() << std::endl;
+  return failed ? 1 : 0;
+}
+
+// bench-numa: median `docker run` wall time per slug unpinned, pinned to node 0's
+// CPUs and memory (local), and to node 0's CPUs with node 1's memory (remote). The
+// remote-local gap is what a job pays when the kernel lets it drift across sockets.
+static int bench_numa(const std::vector<std::string>& slugs, int repeat) {
+  const polyglot::NodeBalancer nodes(polyglot::numa_nodes());
+  std::cout << "NUMA nodes: " << nodes.nodes().size();
+  for (const auto& n : nodes.nodes()) std::cout << "  node" << n.id << "=" << n.cpulist;
+  std::cout << "\n";
+  if (nodes.nodes().empty()) {
+    std::cerr << "No NUMA topology under /sys/devices/system/node\n";
+    return 2;
+  }
+  const int first = nodes.nodes()[0].id;
+  const polyglot::LaunchProfile profile;
+  const std::pair<const char*, polyglot::Placement> columns[] = {
+      {"unpinned", {}}, {"local", nodes.local(first)}, {"remote", nodes.remote(first)}};
+
+  std::printf("%-16s %10s %10s %10s\n", "slug (ms)", "unpinned", "local", "remote");
+  int failures = 0;
+  for (const auto& slug : slugs) {
+    std::printf("%-16s", slug.c_str());
+    for (const auto& [name, placement] : columns) {
+      if (std::string(name) != "unpinned" && placement.node < 0) {
+        std::printf(" %10s", "n/a");  // remote needs a second node
+        continue;
+      }
+      std::vector<double> ms;
+      bool failed = false;
+      for (int r = 0; r < repeat && !failed; ++r) {
+        const auto t0 = std::chrono::steady_clock::now();
+        failed = spawn_quiet(run_args(slug, profile, placement)) != 0;
+        ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+      }
+      if (failed) {
+        std::printf(" %10s", "FAIL");
+        ++failures;
+        continue;
+      }
+      std::sort(ms.begin(), ms.end());
+      std::printf(" %10.1f", ms[ms.size() / 2]);
+    }
+    std::printf("\n");
+    std::fflush(stdout);
+  }
+  return failures ? 1 : 0;
+}
+
+// Languages this build knows about. With $POLYGLOT_ARCHIVE set, the ones in the
+// archive. With the embedded registry that is a table lookup, no parsing; it is only
+// trusted while languages.tsv still hashes to what it was generated from, otherwise
+// we fall back to parsing the manifest.
+class Languages {
+ public:
+  explicit Languages(const fs::path& root) : manifest_path_(root / "languages.tsv") {
+    if (const char* archive = archive_path()) {
+      entries_ = polyglot::read_tar(polyglot::read_archive(archive));
+      archived_ = polyglot::archive_slugs(entries_);
+      for (const auto& e : entries_) {
+        const std::string prefix = "languages/", leaf = "/Dockerfile";
+        if (e.path.size() <= prefix.size() + leaf.size() || e.path.compare(0, prefix.size(), prefix) != 0 ||
+            e.path.compare(e.path.size() - leaf.size(), leaf.size(), leaf) != 0) {
+          continue;
+        }
+        const std::string slug = e.path.substr(prefix.size(), e.path.size() - prefix.size() - leaf.size());
+        if (e.content.compare(0, 5, "FROM ") == 0) {
+          archived_bases_.emplace_back(slug, e.content.substr(5, e.content.find('\n') - 5));
+        }
+      }
+      return;
+    }
+#ifdef POLYGLOT_EMBEDDED_REGISTRY
+    if (polyglot::fnv1a(polyglot::read_file_or_empty(manifest_path_)) == polyglot::embedded::kManifestHash) {
+      registry_ = &polyglot::embedded::kRegistry;
+      return;
+    }
+    std::cerr << "polyglot: embedded registry is stale, reading languages.tsv\n";
+#endif
+    manifest_.emplace(polyglot::Manifest::load(manifest_path_));
+  }
+
+  bool contains(const std::string& slug) const {
+    if (archived_) return std::find(archived_->begin(), archived_->end(), slug) != archived_->end();
+    if (registry_) return registry_->find(slug) != nullptr;
+    return manifest_->find(slug) != nullptr;
+  }
+
+  // The slug's base image, "" if unknown.
+  std::string base_image(const std::string& slug) const {
+    if (archived_) {
+      for (const auto& [s, image] : archived_bases_) {
+        if (s == slug) return image;
+      }
+      return "";
+    }
+    if (registry_) {
+      const auto* e = registry_->find(slug);
+      return e ? std::string(e->base_image) : "";
+    }
+    const auto* spec = manifest_->find(slug);
+    return spec ? spec->base_image : "";
+  }
+
+  // The slug's declared cpu/mem classes; nothing is declared in an archive.
+  polyglot::Resources resources(const std::string& slug) const {
+    if (archived_) return {};
+    if (registry_) {
+      const auto* e = registry_->find(slug);
+      polyglot::LangSpec spec;
+      if (e) spec = polyglot::to_lang_spec(*e);
+      return polyglot::declared_resources(spec);
+    }
+    const auto* spec = manifest_->find(slug);
+    return spec ? polyglot::declared_resources(*spec) : polyglot::Resources{};
+  }
+
+  // The parsed $POLYGLOT_ARCHIVE, empty without one.
+  const std::vector<polyglot::TarEntry>& archive_entries() const { return entries_; }
+
+  std::vector<std::string> slugs() const {
+    if (archived_) return *archived_;
+    if (!registry_) return manifest_->slugs();
+    std::vector<std::string> out;
+    for (size_t i = 0; i < registry_->count; ++i) out.emplace_back(registry_->entries[i].slug);
+    return out;
+  }
+
+ private:
+  fs::path manifest_path_;
+  const polyglot::Registry* registry_ = nullptr;
+  std::optional<polyglot::Manifest> manifest_;
+  std::optional<std::vector<std::string>> archived_;
+  std::vector<polyglot::TarEntry> entries_;
+  std::vector<std::pair<std::string, std::string>> archived_bases_;
+};
+
+// Simulation profiles for slugs: replayed from the history store where it has them,
+// synthetic otherwise (and for whatever the history lacks, e.g. memory footprints).
+static std::map<std::string, polyglot::SlugProfile> sim_profiles(const Languages& langs,
+                                                                 const std::vector<std::string>& slugs,
+                                                                 const fs::path& history, uint64_t seed) {
+  auto observed = history.empty() ? std::map<std::string, polyglot::SlugProfile>{} : polyglot::history_profiles(history);
+  std::map<std::string, polyglot::SlugProfile> out;
+  for (const auto& slug : slugs) {
+    polyglot::SlugProfile p = polyglot::synthetic_profile(slug, langs.base_image(slug), seed);
+    if (auto it = observed.find(slug); it != observed.end()) {
+      if (!it->second.build_s.empty()) p.build_s = it->second.build_s;
+      if (!it->second.run_s.empty()) p.run_s = it->second.run_s;
+      p.fail_rate = it->second.fail_rate;
+    }
+    out[slug] = std::move(p);
+  }
+  return out;
+}
+
+// simulate: every policy over many virtual sweeps of the same profiles.
+static int simulate(const std::map<std::string, polyglot::SlugProfile>& profiles,
+                    const std::vector<polyglot::SimPolicy>& policies, const polyglot::SimOptions& opts,
+                    size_t sweeps, uint64_t seed) {
+  std::vector<polyglot::SlugProfile> jobs;
+  for (const auto& [slug, p] : profiles) jobs.push_back(p);
+  std::printf("%zu jobs, %u slots, %.0f MiB, %zu sweeps\n", jobs.size(), opts.slots, opts.mem_mb, sweeps);
+  std::printf("%-10s %14s %14s %8s %14s %8s\n", "policy", "makespan s", "p95 makespan", "util", "p95 wait s",
+              "failed");
+  for (auto policy : policies) {
+    const auto r = polyglot::simulate(jobs, policy, opts, sweeps, seed);
+    std::printf("%-10s %14.1f %14.1f %7.1f%% %14.1f %7.2f%%\n", polyglot::sim_policy_name(policy), r.makespan_mean,
+                r.makespan_p95, 100 * r.utilization, r.queue_wait_p95, 100 * r.fail_rate);
+  }
+  return 0;
+}
+
+// RootFS layer digests of each slug's hello-<slug> image, from one `docker image
+// inspect` call. Images that don't exist yet are simply missing from the result.
+static std::map<std::string, std::vector<std::string>> image_layers(const std::vector<std::string>& slugs) {
+  std::map<std::string, std::vector<std::string>> out;
+  if (slugs.empty()) return out;
+  std::string cmd = "docker image inspect -f '{{range .RepoTags}}{{.}},{{end}} {{join .RootFS.Layers \",\"}}'";
+  for (const auto& slug : slugs) cmd += " hello-" + slug;  // slugs are [a-z0-9_-], no quoting needed
+  cmd += " 2>/dev/null";
+  FILE* pipe = popen(cmd.c_str(), "r");
+  if (!pipe) return out;
+  std::string text;
+  char buf[4096];
+  for (size_t n; (n = fread(buf, 1, sizeof(buf), pipe)) > 0;) text.append(buf, n);
+  pclose(pipe);  // non-zero whenever any image is missing; the others still print
+
+  std::istringstream in(text);
+  for (std::string line; std::getline(in, line);) {
+    const size_t space = line.find(' ');
+    if (space == std::string::npos) continue;
+    std::vector<std::string> layers;
+    std::istringstream ls(line.substr(space + 1));
+    for (std::string l; std::getline(ls, l, ',');) {
+      if (!l.empty()) layers.push_back(l);
+    }
+    std::istringstream tags(line.substr(0, space));
+    for (std::string tag; std::getline(tags, tag, ',');) {
+      if (tag.compare(0, 6, "hello-") != 0) continue;
+      const size_t colon = tag.rfind(':');
+      out[tag.substr(6, colon == std::string::npos ? std::string::npos : colon - 6)] = layers;
+    }
+  }
+  return out;
+}
+
+// order locality: prints slugs so that images sharing a base and layers run back to
+// back (see locality.hpp), and on stderr how many layer loads that saves over
+// alphabetical order.
+static int order_locality(const Languages& langs, std::vector<std::string> slugs) {
+  const auto layers = image_layers(slugs);
+  std::vector<polyglot::ImageInfo> images;
+  for (const auto& slug : slugs) {
+    polyglot::ImageInfo im{slug, langs.base_image(slug), {}};
+    if (auto it = layers.find(slug); it != layers.end()) im.layers = it->second;
+    images.push_back(std::move(im));
+  }
+  const auto order = polyglot::locality_order(images);
+  for (const auto& slug : order) std::cout << slug << "\n";
+
+  std::sort(slugs.begin(), slugs.end());
+  std::cerr << "locality: " << layers.size() << "/" << images.size() << " images inspected, layer loads "
+            << polyglot::layer_transitions(images, slugs) << " alphabetical -> "
+            << polyglot::layer_transitions(images, order) << " ordered\n";
+  return 0;
+}
+
+static int verify_registry(const fs::path& root) {
+#ifdef POLYGLOT_EMBEDDED_REGISTRY
+  const auto m = polyglot::Manifest::load(root / "languages.tsv");
+  const auto problems = polyglot::verify_registry(polyglot::embedded::kRegistry, m);
+  for (const auto& p : problems) std::cout << p << "\n";
+  if (!problems.empty()) {
+    std::cout << problems.size() << " difference(s); rerun scaffold and rebuild polyglot\n";
+    return 1;
+  }
+  std::cout << "Embedded registry matches languages.tsv (" << m.slugs().size() << " languages)\n";
+  return 0;
+#else
+  (void)root;
+  std::cerr << "polyglot was built without -DPOLYGLOT_EMBEDDED_REGISTRY\n";
+  return 2;
+#endif
+}
+
+static std::string resource_cell(const polyglot::Resources& r) {
+  if (r.cpus <= 0 && r.mem_mb == 0 && r.width == 0) return "-";
+  char cpu[24] = "-", mem[24] = "-";
+  if (r.cpus > 0) std::snprintf(cpu, sizeof(cpu), "%.3g", r.cpus);
+  if (r.mem_mb) std::snprintf(mem, sizeof(mem), "%llum", (unsigned long long)r.mem_mb);
+  return std::string(cpu) + " cpu, " + mem + (r.width ? ", x" + std::to_string(r.width) : "");
+}
+
+// resources: per slug, the declared cpu/mem (enforced on runs) and width ("x4"), what
+// its run containers were seen to use, and what sweep admission reserves for it.
+static int resources(const Languages& langs, const std::vector<std::string>& slugs, const fs::path& history) {
+  const auto observed = polyglot::observed_resources(history);
+  const polyglot::Resources host = polyglot::host_capacity();
+  std::printf("host: %s\n", resource_cell(host).c_str());
+  std::printf("%-16s %18s %18s %18s\n", "slug", "declared", "observed", "reserved");
+  for (const auto& slug : slugs) {
+    if (!langs.contains(slug)) {
+      std::cerr << "Unknown language: " << slug << "\n";
+      return 2;
+    }
+    const polyglot::Resources declared = langs.resources(slug);
+    const auto it = observed.find(slug);
+    const polyglot::Resources* seen = it == observed.end() ? nullptr : &it->second;
+    const polyglot::Resources reserved = polyglot::resource_request(declared, seen);
+    std::printf("%-16s %18s %18s %18s\n", slug.c_str(), resource_cell(declared).c_str(),
+                seen ? resource_cell(*seen).c_str() : "-", resource_cell(reserved).c_str());
+  }
+  return 0;
+}
+
+static int usage() {
+  std::cerr << "Usage: polyglot <build|run|all> <slug>\n"
+               "       polyglot list\n"
+               "       polyglot affected <git-rev>\n"
+               "       polyglot order locality [slug...]\n"
+               "       polyglot logs <slug> [--sweep ID] [--phase build|run] [--attempt N]\n"
+               "       polyglot logs --list [--sweep ID]\n"
+               "       polyglot resources [--history FILE] [slug...]\n"
+               "       polyglot build-cache report [--sweep ID]\n"
+               "       polyglot build-cache prune [--dir DIR] [--max-gb X]\n"
+               "       polyglot proxy [--listen HOST:PORT] [--dir DIR] [--offline] [--index-ttl S] [--sweep-id ID]\n"
+               "       polyglot verify-registry\n"
+               "       polyglot bench-launch [--repeat N] <slug>...\n"
+               "       polyglot bench-numa [--repeat N] <slug>...\n"
+               "       polyglot sweep [--jobs N] [--numa] [--retries N] [--retry-budget N] [--fail-fast]\n"
+               "                      [--non-blocking slug,...] [--sweep-id ID] [--history FILE] [--log-dir DIR] [--verbose]\n"
+               "                      [--cpus N] [--mem-gb X] [--no-admit]\n"
+               "                      [--backend docker|sim] [--time-scale X] <slug>...\n"
+               "       polyglot simulate [--slots N] [--sweeps N] [--seed N] [--retries N] [--mem-gb X] [--mem-slowdown X]\n"
+               "                         [--cold-penalty X] [--warm-images N] [--history FILE | --synthetic]\n"
+               "                         [--policies fifo,lpt,locality,adaptive,shard] [slug...]\n";
+  return 2;
+}
+
+// logs: one job's full output from a sweep's log archive (see logs.hpp).
+//   logs <slug> [--sweep ID] [--phase build|run] [--attempt N]   newest sweep with the slug by default
+//   logs --list [--sweep ID]                                       what a sweep's archive holds
+//   logs add <sweep> <slug> <phase> <attempt> <exit> <stdout-file> <stderr-file>
+// `add` is how the serial runner archives a phase it ran itself.
+static int logs(const fs::path& root, int argc, char** argv) {
+  const fs::path dir = root / ".polyglot" / "logs";
+  if (argc == 8 && std::string(argv[0]) == "add") {
+    polyglot::LogArchive archive(dir, argv[1]);
+    archive.add(argv[2], argv[3], std::atoi(argv[4]), std::atoi(argv[5]), polyglot::read_file_or_empty(argv[6]),
+                polyglot::read_file_or_empty(argv[7]));
+    return 0;
+  }
+  std::string slug, sweep_id, phase;
+  int attempt = 0;
+  bool list = false;
+  for (int i = 0; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--sweep" && i + 1 < argc) sweep_id = argv[++i];
+    else if (arg == "--phase" && i + 1 < argc) phase = argv[++i];
+    else if (arg == "--attempt" && i + 1 < argc) attempt = std::atoi(argv[++i]);
+    else if (arg == "--list") list = true;
+    else if (arg.compare(0, 2, "--") != 0 && slug.empty()) slug = arg;
+    else return usage();
+  }
+  if (slug.empty() && !list) return usage();
+
+  std::vector<std::string> sweeps = sweep_id.empty() ? polyglot::log_sweeps(dir) : std::vector<std::string>{sweep_id};
+  if (sweeps.empty()) {
+    std::cerr << "No log archives in " << dir.string() << "\n";
+    return 1;
+  }
+  if (list) {
+    const std::string id = sweeps.back();
+    for (const auto& r : polyglot::read_log_index(dir, id)) {
+      std::printf("%s\t%s\t%s\t%d\t%d\t%llu\t%llu\n", id.c_str(), r.slug.c_str(), r.phase.c_str(), r.attempt,
+                  r.status, (unsigned long long)r.size, (unsigned long long)r.compressed_size);
+    }
+    return 0;
+  }
+  for (auto it = sweeps.rbegin(); it != sweeps.rend(); ++it) {
+    bool found = false;
+    for (const auto& r : polyglot::read_log_index(dir, *it)) {
+      if (r.slug != slug || (!phase.empty() && r.phase != phase) || (attempt && r.attempt != attempt)) continue;
+      if (!found) std::cerr << "sweep " << *it << "\n";
+      found = true;
+      std::cout << polyglot::read_log(dir, *it, r);
+    }
+    if (found) return 0;
+  }
+  std::cerr << "No logs for " << slug << (sweep_id.empty() ? "" : " in sweep " + sweep_id) << "\n";
+  return 1;
+}
+
+// build-cache: what the local BuildKit cache achieved and keeping it bounded.
+//   build-cache report [--sweep ID]   steps cached per sweep, from the log archives
+//   build-cache prune [--dir DIR] [--max-gb X]
+static int build_cache(int argc, char** argv) {
+  if (argc < 1) return usage();
+  const std::string sub = argv[0];
+  std::string sweep_id;
+  fs::path dir = build_cache_dir() ? build_cache_dir() : "";
+  double max_gb = 10;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--sweep" && i + 1 < argc) sweep_id = argv[++i];
+    else if (arg == "--dir" && i + 1 < argc) dir = argv[++i];
+    else if (arg == "--max-gb" && i + 1 < argc) max_gb = std::atof(argv[++i]);
+    else return usage();
+  }
+
+  if (sub == "prune") {
+    if (dir.empty()) throw std::runtime_error("build-cache prune needs --dir or POLYGLOT_BUILD_CACHE");
+    const auto r = polyglot::prune_build_cache(dir, (uint64_t)(max_gb * 1024 * 1024 * 1024));
+    std::printf("%.1f MiB -> %.1f MiB (budget %.1f GiB): %zu stale blobs removed, %zu shared blobs linked, "
+                "%zu slugs evicted\n",
+                r.before / 1048576.0, r.after / 1048576.0, max_gb, r.blobs_removed, r.blobs_linked, r.evicted.size());
+    for (const auto& slug : r.evicted) std::printf("evicted %s\n", slug.c_str());
+    return 0;
+  }
+  if (sub != "report") return usage();
+
+  // Build phases are in the sweep log archives; a retried build counts once per attempt.
+  const fs::path logs = find_root() / ".polyglot" / "logs";
+  const auto sweeps = sweep_id.empty() ? polyglot::log_sweeps(logs) : std::vector<std::string>{sweep_id};
+  if (sweeps.empty()) {
+    std::cerr << "No log archives in " << logs.string() << "\n";
+    return 1;
+  }
+  for (const auto& id : sweeps) {
+    polyglot::CacheSteps total;
+    size_t builds = 0;
+    std::vector<std::string> cold;
+    for (const auto& r : polyglot::read_log_index(logs, id)) {
+      if (r.phase != "build") continue;
+      const auto steps = polyglot::cache_steps(polyglot::read_log(logs, id, r));
+      ++builds;
+      total.steps += steps.steps;
+      total.cached += steps.cached;
+      if (steps.steps && !steps.cached) cold.push_back(r.slug);
+    }
+    std::printf("%s\t%zu/%zu steps cached (%.0f%%) over %zu builds", id.c_str(), total.cached, total.steps,
+                total.steps ? 100.0 * (double)total.cached / (double)total.steps : 0.0, builds);
+    if (!cold.empty()) {
+      std::printf("; cold:");
+      for (const auto& slug : cold) std::printf(" %s", slug.c_str());
+    }
+    std::printf("\n");
+  }
+  return 0;
+}
+
+static std::atomic<bool> g_proxy_stop{false};
+
+// proxy: the package download cache builds reach through http_proxy (see proxy.hpp).
+// Prints "listening <host:port>" once ready; on SIGINT/SIGTERM prints
+// "#proxy<TAB><summary>" and, with --sweep-id, appends the counters to
+// <dir>/stats.tsv as sweep_id hits misses bytes_saved bytes_fetched passthrough
+// tunnels errors.
+static int proxy(int argc, char** argv) {
+  polyglot::ProxyOptions opts;
+  std::string sweep_id;
+  for (int i = 0; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--listen" && i + 1 < argc) opts.listen = argv[++i];
+    else if (arg == "--dir" && i + 1 < argc) opts.dir = argv[++i];
+    else if (arg == "--index-ttl" && i + 1 < argc) opts.index_ttl_s = std::atoi(argv[++i]);
+    else if (arg == "--sweep-id" && i + 1 < argc) sweep_id = argv[++i];
+    else if (arg == "--offline") opts.offline = true;
+    else return usage();
+  }
+  if (opts.dir.empty()) opts.dir = find_root() / ".polyglot" / "proxy";
+  polyglot::PackageProxy server(opts);
+  std::signal(SIGINT, [](int) { g_proxy_stop = true; });
+  std::signal(SIGTERM, [](int) { g_proxy_stop = true; });
+  std::cout << "listening " << server.address() << (opts.offline ? " (offline)" : "") << std::endl;
+  server.serve(g_proxy_stop);
+
+  const polyglot::ProxyStats s = server.stats();
+  std::cout << "#proxy\t" << s.summary() << std::endl;
+  if (!sweep_id.empty()) {
+    std::ofstream(opts.dir / "stats.tsv", std::ios::app)
+        << sweep_id << "\t" << s.hits << "\t" << s.misses << "\t" << s.bytes_saved << "\t" << s.bytes_fetched << "\t"
+        << s.passthrough << "\t" << s.tunnels << "\t" << s.errors << "\n";
+  }
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  try {
+    if (argc < 2) return usage();
+    const std::string cmd = argv[1];
+    // Neither needs the manifest when given explicit directories.
+    if (cmd == "build-cache") return build_cache(argc - 2, argv + 2);
+    if (cmd == "proxy") return proxy(argc - 2, argv + 2);
+    const fs::path root = find_root();
+
+    if (cmd == "list") {
+      for (const auto& slug : Languages(root).slugs()) std::cout << slug << "\n";
+      return 0;
+    }
+
+    if (cmd == "verify-registry") return verify_registry(root);
+
+    if (cmd == "bench-launch") {
+      int repeat = 5;
+      std::vector<std::string> slugs;
+      for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc) repeat = std::max(1, std::atoi(argv[++i]));
+        else slugs.push_back(arg);
+      }
+      if (slugs.empty()) return usage();
+      const Languages langs(root);
+      for (const auto& slug : slugs) {
+        if (!langs.contains(slug)) {
+          std::cerr << "Unknown language: " << slug << "\n";
+          return 2;
+        }
+      }
+      return bench_launch(slugs, repeat);
+    }
+
+    if (cmd == "bench-numa") {
+      int repeat = 5;
+      std::vector<std::string> slugs;
+      for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc) repeat = std::max(1, std::atoi(argv[++i]));
+        else slugs.push_back(arg);
+      }
+      if (slugs.empty()) return usage();
+      return bench_numa(slugs, repeat);
+    }
+
+    if (cmd == "sweep") {
+      polyglot::SweepOptions opts;
+      opts.capacity = polyglot::host_capacity();
+      bool numa = false, verbose = false;
+      std::string backend_name = "docker";
+      double time_scale = 0;
+      fs::path log_dir;
+      std::vector<std::string> slugs;
+      for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--jobs" && i + 1 < argc) opts.jobs = (unsigned)std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--backend" && i + 1 < argc) backend_name = argv[++i];
+        else if (arg == "--log-dir" && i + 1 < argc) log_dir = argv[++i];
+        else if (arg == "--time-scale" && i + 1 < argc) time_scale = std::atof(argv[++i]);
+        else if (arg == "--retries" && i + 1 < argc) opts.retries = std::atoi(argv[++i]);
+        else if (arg == "--retry-budget" && i + 1 < argc) opts.retry_budget = std::atoi(argv[++i]);
+        else if (arg == "--sweep-id" && i + 1 < argc) opts.sweep_id = argv[++i];
+        else if (arg == "--history" && i + 1 < argc) opts.history = argv[++i];
+        else if (arg == "--fail-fast") opts.fail_fast = true;
+        else if (arg == "--non-blocking" && i + 1 < argc) {
+          std::istringstream list(argv[++i]);
+          for (std::string slug; std::getline(list, slug, ',');) {
+            if (!slug.empty()) opts.non_blocking.insert(slug);
+          }
+        }
+        else if (arg == "--numa") numa = true;
+        else if (arg == "--verbose") verbose = true;
+        else if (arg == "--cpus" && i + 1 < argc) opts.capacity.cpus = std::atof(argv[++i]);
+        else if (arg == "--mem-gb" && i + 1 < argc) opts.capacity.mem_mb = (uint64_t)(std::atof(argv[++i]) * 1024);
+        else if (arg == "--no-admit") opts.capacity = {};
+        else if (arg.compare(0, 2, "--") == 0) return usage();
+        else slugs.push_back(arg);
+      }
+      const Languages langs(root);
+      const auto observed =
+          opts.history.empty() ? std::map<std::string, polyglot::Resources>{} : polyglot::observed_resources(opts.history);
+      std::map<std::string, polyglot::Resources> limits;
+      for (const auto& slug : slugs) {
+        if (!langs.contains(slug)) {
+          std::cerr << "Unknown language: " << slug << "\n";
+          return 2;
+        }
+        limits[slug] = langs.resources(slug);
+        const auto it = observed.find(slug);
+        opts.requests[slug] = polyglot::resource_request(limits[slug], it == observed.end() ? nullptr : &it->second);
+      }
+      std::optional<polyglot::LogArchive> logs;
+      if (!log_dir.empty() && backend_name == "docker") {
+        if (opts.sweep_id.empty()) throw std::runtime_error("--log-dir needs --sweep-id");
+        opts.logs = &logs.emplace(log_dir, opts.sweep_id);
+      }
+      if (backend_name == "sim") {
+        // Replays the history store (or synthetic profiles) and records nothing, so
+        // simulated results never feed back into it.
+        polyglot::SimBackend backend(sim_profiles(langs, slugs, opts.history, 1), time_scale, 1);
+        opts.history.clear();
+        return sweep(slugs, opts, numa, verbose, backend);
+      }
+      if (backend_name != "docker") return usage();
+      proxy_args();  // rejects an unusable POLYGLOT_PROXY before any job starts
+      DockerBackend backend(root, std::move(limits), langs.archive_entries());
+      return sweep(slugs, opts, numa, verbose, backend);
+    }
+
+    if (cmd == "simulate") {
+      polyglot::SimOptions opts;
+      fs::path history = root / ".polyglot" / "history.tsv";
+      size_t sweeps = 1000;
+      uint64_t seed = 1;
+      std::vector<polyglot::SimPolicy> policies = {polyglot::SimPolicy::kFifo, polyglot::SimPolicy::kLpt,
+                                                   polyglot::SimPolicy::kLocality, polyglot::SimPolicy::kAdaptive,
+                                                   polyglot::SimPolicy::kShard};
+      std::vector<std::string> slugs;
+      for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--slots" && i + 1 < argc) opts.slots = (unsigned)std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--sweeps" && i + 1 < argc) sweeps = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--seed" && i + 1 < argc) seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--retries" && i + 1 < argc) opts.retries = std::atoi(argv[++i]);
+        else if (arg == "--mem-gb" && i + 1 < argc) opts.mem_mb = std::atof(argv[++i]) * 1024;
+        else if (arg == "--mem-slowdown" && i + 1 < argc) opts.mem_slowdown = std::atof(argv[++i]);
+        else if (arg == "--cold-penalty" && i + 1 < argc) opts.cold_penalty = std::atof(argv[++i]);
+        else if (arg == "--warm-images" && i + 1 < argc) opts.warm_images = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--history" && i + 1 < argc) history = argv[++i];
+        else if (arg == "--synthetic") history.clear();
+        else if (arg == "--policies" && i + 1 < argc) {
+          policies.clear();
+          std::stringstream ss(argv[++i]);
+          for (std::string name; std::getline(ss, name, ',');) policies.push_back(polyglot::sim_policy_named(name));
+        } else if (arg.compare(0, 2, "--") == 0) {
+          return usage();
+        } else {
+          slugs.push_back(arg);
+        }
+      }
+      const Languages langs(root);
+      if (slugs.empty()) slugs = langs.slugs();
+      return simulate(sim_profiles(langs, slugs, history, seed), policies, opts, sweeps, seed);
+    }
+
+    if (cmd == "logs") return logs(root, argc - 2, argv + 2);
+
+    if (cmd == "resources") {
+      fs::path history = root / ".polyglot" / "history.tsv";
+      std::vector<std::string> slugs;
+      for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--history" && i + 1 < argc) history = argv[++i];
+        else if (arg.compare(0, 2, "--") == 0) return usage();
+        else slugs.push_back(arg);
+      }
+      const Languages langs(root);
+      if (slugs.empty()) slugs = langs.slugs();
+      return resources(langs, slugs, history);
+    }
+
+    if (cmd == "order") {
+      if (argc < 3 || std::string(argv[2]) != "locality") return usage();
+      const Languages langs(root);
+      std::vector<std::string> slugs(argv + 3, argv + argc);
+      if (slugs.empty()) slugs = langs.slugs();
+      for (const auto& slug : slugs) {
+        if (!langs.contains(slug)) {
+          std::cerr << "Unknown language: " << slug << "\n";
+          return 2;
+        }
+      }
+      return order_locality(langs, slugs);
+    }
+
+    if (cmd == "affected" && argc == 3) {
+      fs::current_path(root);
+      for (const auto& slug : polyglot::affected_slugs("languages.tsv", argv[2])) std::cout << slug << "\n";
+      return 0;
+    }
+
+    if (argc != 3 || (cmd != "build" && cmd != "run" && cmd != "all")) return usage();
+    const std::string slug = argv[2];
+
+    const Languages langs(root);
+    if (!langs.contains(slug)) {
+      std::cerr << "Unknown language: " << slug << "\n";
+      return 2;
+    }
+
+    if (cmd != "run") {
+      int rc = docker_build(root, slug, langs.archive_entries());
+      if (rc != 0) return rc;
+    }
+    if (cmd != "build") return docker_run(slug, langs.resources(slug));
+    return 0;
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n";
+    return 1;
+  }
+}
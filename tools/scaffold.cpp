@@ -1,504 +1,587 @@
 #include <algorithm>
-#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <filesystem>
 #include <fstream>
-#include <iomanip>
 #include <iostream>
-#include <sstream>
+#include <memory>
 #include <string>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#include "libpolyglot/polyglot.hpp"
+
 namespace fs = std::filesystem;
+using namespace polyglot;
 
-static std::vector<std::string> split_tabs(const std::string& s) {
-  std::vector<std::string> out;
-  std::string cur;
-  for (char c : s) {
-    if (c == '\t') { out.push_back(cur); cur.clear(); }
-    else { cur.push_back(c); }
-  }
-  out.push_back(cur);
-  return out;
-}
+// scaffold: generate languages/<slug>/ from languages.tsv. Parsing, fixups and
+// rendering live in libpolyglot; this file is the command-line front end.
 
-static std::string trim(std::string s) {
-  auto notspace = [](unsigned char ch) { return !std::isspace(ch); };
-  s.erase(s.begin(), std::find_if(s.begin(), s.end(), notspace));
-  s.erase(std::find_if(s.rbegin(), s.rend(), notspace).base(), s.end());
-  return s;
+static std::string render_registry(const std::string& manifest_text) {
+  return emit_registry(Manifest::parse(manifest_text), fnv1a(manifest_text));
 }
 
-static std::string lower(std::string s) {
-  std::transform(s.begin(), s.end(), s.begin(),
-                 [](unsigned char c) { return (char)std::tolower(c); });
-  return s;
+static int check(const fs::path& manifest, const fs::path& languages_dir, const fs::path& registry) {
+  std::ifstream in(manifest);
+  if (!in) {
+    std::cerr << "Cannot open manifest: " << manifest << "\n";
+    return 2;
+  }
+  const std::string text = read_file_or_empty(manifest);
+  const auto drift = check_tree(Manifest::parse(text), languages_dir);
+
+  size_t added = 0, changed = 0, removed = 0;
+  for (const auto& d : drift) {
+    for (const auto& f : d.added)   std::cout << d.slug << ": added "   << f << "\n";
+    for (const auto& f : d.changed) std::cout << d.slug << ": changed " << f << "\n";
+    for (const auto& f : d.removed) std::cout << d.slug << ": removed " << f << "\n";
+    added += d.added.size();
+    changed += d.changed.size();
+    removed += d.removed.size();
+  }
+
+  // --affected and --watch only notice template edits in the listed sources.
+  const auto unlisted = unlisted_generator_sources();
+  for (const auto& src : unlisted) std::cout << src << ": included by the generator but not in kGeneratorSources\n";
+
+  bool registry_stale = false;
+  if (!registry.empty() && fs::exists(registry) && read_file_or_empty(registry) != render_registry(text)) {
+    std::cout << registry.string() << ": out of date\n";
+    registry_stale = true;
+  }
+
+  if (drift.empty() && !registry_stale && unlisted.empty()) {
+    std::cout << "Up to date: languages/ matches " << manifest.string() << "\n";
+    return 0;
+  }
+  if (drift.empty()) return 1;
+  std::cout << "Drift in " << drift.size() << " slug(s): " << added << " added, " << changed
+            << " changed, " << removed << " removed (run scaffold to regenerate)\n";
+  return 1;
 }
 
-// Unescape TSV fields (supports \n \t \r \\ \" \')
-static std::string unescape(const std::string& s) {
-  std::string out;
-  out.reserve(s.size());
-  for (size_t i = 0; i < s.size(); ++i) {
-    if (s[i] == '\\' && i + 1 < s.size()) {
-      char n = s[i + 1];
-      if (n == 'n')  { out.push_back('\n'); ++i; continue; }
-      if (n == 't')  { out.push_back('\t'); ++i; continue; }
-      if (n == 'r')  { out.push_back('\r'); ++i; continue; }
-      if (n == '\\') { out.push_back('\\'); ++i; continue; }
-      if (n == '"')  { out.push_back('"');  ++i; continue; }
-      if (n == '\'') { out.push_back('\''); ++i; continue; }
+// ---- watch: regenerate only rows whose parsed spec changed ----
+
+// Blocks until one of the watched files changes. Uses inotify on Linux (on the parent
+// directories, since editors usually save by rename) and mtime polling elsewhere.
+class FileWatcher {
+ public:
+  explicit FileWatcher(std::vector<fs::path> files) : files_(std::move(files)) {
+    for (const auto& f : files_) stamps_.push_back(stamp(f));
+#ifdef __linux__
+    fd_ = inotify_init1(IN_CLOEXEC);
+    if (fd_ >= 0) {
+      for (const auto& f : files_) {
+        auto dir = f.parent_path().empty() ? fs::path(".") : f.parent_path();
+        inotify_add_watch(fd_, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+      }
     }
-    out.push_back(s[i]);
+#endif
   }
-  return out;
-}
 
-static std::string strip_utf8_bom(std::string s) {
-  // UTF-8 BOM: EF BB BF
-  if (s.size() >= 3 &&
-      (unsigned char)s[0] == 0xEF &&
-      (unsigned char)s[1] == 0xBB &&
-      (unsigned char)s[2] == 0xBF) {
-    s.erase(0, 3);
+  ~FileWatcher() {
+    if (fd_ >= 0) ::close(fd_);
   }
-  return s;
-}
 
-static bool ends_with_nl(const std::string& s) {
-  return !s.empty() && (s.back() == '\n');
-}
+  FileWatcher(const FileWatcher&) = delete;
+  FileWatcher& operator=(const FileWatcher&) = delete;
+
+  // Returns the watched files that changed since the previous call.
+  std::vector<fs::path> wait() {
+    for (;;) {
+      if (fd_ >= 0) {
+        drain(-1);
+        // Debounce: editors often write in several steps.
+        while (drain(100)) {}
+      } else {
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+      }
 
-// Docker exec-form CMD is JSON. Escape so generated Dockerfile is always valid JSON.
-static std::string json_escape(const std::string& s) {
-  std::string out;
-  out.reserve(s.size() + 8);
-  for (unsigned char c : s) {
-    switch (c) {
-      case '\\': out += "\\\\"; break;
-      case '"':  out += "\\\""; break;
-      case '\n': out += "\\n"; break;
-      case '\r': out += "\\r"; break;
-      case '\t': out += "\\t"; break;
-      default:
-        if (c < 0x20) {
-          std::ostringstream oss;
-          oss << "\\u" << std::hex << std::uppercase
-              << std::setw(4) << std::setfill('0') << (int)c;
-          out += oss.str();
-        } else {
-          out.push_back((char)c);
+      std::vector<fs::path> changed;
+      for (size_t i = 0; i < files_.size(); ++i) {
+        auto now = stamp(files_[i]);
+        if (now != stamps_[i]) {
+          stamps_[i] = now;
+          changed.push_back(files_[i]);
         }
+      }
+      if (!changed.empty()) return changed;
     }
   }
-  return out;
-}
-
-static std::string read_file_or_empty(const fs::path& p) {
-  std::ifstream f(p, std::ios::binary);
-  if (!f) return "";
-  std::ostringstream oss;
-  oss << f.rdbuf();
-  return oss.str();
-}
 
-// Writes if missing OR content differs (durable; avoids needing --force).
-static bool write_file_if_changed(const fs::path& p, const std::string& content) {
-  std::string existing = read_file_or_empty(p);
-  if (!existing.empty() && existing == content) return false;
-
-  std::ofstream f(p, std::ios::binary);
-  if (!f) throw std::runtime_error("Failed to write: " + p.string());
-  f << content;
-  return true;
-}
+ private:
+  static std::string stamp(const fs::path& p) {
+    std::error_code ec;
+    auto t = fs::last_write_time(p, ec);
+    if (ec) return "";
+    auto size = fs::file_size(p, ec);
+    return std::to_string(t.time_since_epoch().count()) + ":" + std::to_string(ec ? 0 : size);
+  }
 
-// Keep --force semantics for people who want to blast everything,
-// but the default behavior now still updates when content differs.
-static bool write_file(const fs::path& p, const std::string& content, bool force) {
-  if (force) {
-    std::ofstream f(p, std::ios::binary);
-    if (!f) throw std::runtime_error("Failed to write: " + p.string());
-    f << content;
-    return true;
+  // Waits up to timeout_ms for inotify events and discards them. True if any arrived.
+  bool drain(int timeout_ms) {
+    struct pollfd pfd = {fd_, POLLIN, 0};
+    if (::poll(&pfd, 1, timeout_ms) <= 0) return false;
+    char buf[4096];
+    return ::read(fd_, buf, sizeof(buf)) > 0;
   }
-  return write_file_if_changed(p, content);
-}
 
-static bool looks_like_header(const std::vector<std::string>& cols) {
-  if (cols.empty()) return false;
-  return lower(trim(cols[0])) == "slug";
-}
+  std::vector<fs::path> files_;
+  std::vector<std::string> stamps_;
+  int fd_ = -1;
+};
 
-static bool ends_with(const std::string& s, const std::string& suf) {
-  return s.size() >= suf.size() && s.compare(s.size() - suf.size(), suf.size(), suf) == 0;
-}
+static int watch(const fs::path& manifest, const fs::path& languages_dir, const fs::path& registry,
+                 MerkleIndex& index, bool force, bool run_after) {
+  // Raw row text -> parse result; unchanged rows are never re-parsed.
+  struct Parsed { bool ok; LangSpec spec; };
+  std::unordered_map<std::string, Parsed> row_cache;
+  std::string header;
+  std::unordered_map<std::string, LangSpec> current; // slug -> spec, last row wins
+
+  std::vector<fs::path> files = {manifest};
+  for (size_t i = 0; i < kGeneratorSourceCount; ++i) {
+    if (fs::exists(kGeneratorSources[i])) files.push_back(kGeneratorSources[i]);
+  }
+  FileWatcher watcher(files);
 
-static std::string file_ext(const std::string& s) {
-  auto pos = s.rfind('.');
-  if (pos == std::string::npos) return "";
-  return s.substr(pos); // includes '.'
-}
+  for (bool first_round = true;; first_round = false) {
+    std::ifstream in(manifest);
+    if (!in) {
+      std::cerr << "Cannot open manifest: " << manifest << "\n";
+    } else {
+      std::string first;
+      std::getline(in, first);
+      ManifestParser parser;
+      const bool has_header = parser.read_header(first);
+      if (first != header) row_cache.clear();  // column layout may have moved
+      header = first;
+
+      std::unordered_map<std::string, Parsed> next_cache;
+      std::unordered_map<std::string, LangSpec> next;
+      std::vector<std::string> order;
+      auto take = [&](const std::string& line) {
+        auto it = next_cache.find(line);
+        if (it == next_cache.end()) {
+          auto old = row_cache.find(line);
+          if (old != row_cache.end()) {
+            it = next_cache.emplace(line, std::move(old->second)).first;
+          } else {
+            Parsed p;
+            p.ok = parser.parse_row(line, p.spec);
+            it = next_cache.emplace(line, std::move(p)).first;
+          }
+        }
+        if (!it->second.ok) return;
+        const auto& spec = it->second.spec;
+        if (!next.count(spec.slug)) order.push_back(spec.slug);
+        next[spec.slug] = spec;
+      };
+      if (!has_header && !first.empty()) take(first);
+      std::string line;
+      while (std::getline(in, line)) take(line);
+      row_cache = std::move(next_cache);
+
+      std::vector<std::string> changed;
+      for (const auto& slug : order) {
+        auto old = current.find(slug);
+        if (old != current.end() && same_spec(old->second, next[slug])) continue;
+        const auto artifacts = render(next[slug]);
+        write_artifacts(languages_dir / slug, artifacts, force);
+        index.update(slug, artifacts);
+        std::cout << "Scaffolded: " << slug << "\n";
+        changed.push_back(slug);
+      }
+      index.retain(order);
+      index.save();
+      if (!registry.empty() && (!changed.empty() || current.size() != next.size())) {
+        write_file_if_changed(registry, render_registry(read_file_or_empty(manifest)));
+      }
+      for (const auto& [slug, spec] : current) {
+        if (!next.count(slug)) std::cout << "Removed from manifest: " << slug << " (languages/" << slug << " left in place)\n";
+      }
+      current = std::move(next);
 
-static std::string strip_trailing_punct(std::string t) {
-  while (!t.empty()) {
-    char c = t.back();
-    if (c == ';' || c == ',' || c == ')' || c == ']' || c == '\r' || c == '\n') t.pop_back();
-    else break;
-  }
-  return t;
-}
+      if (run_after && !first_round && !changed.empty()) {
+        std::string cmd = "./run_all.sh";
+        for (const auto& slug : changed) cmd += " " + shell_quote(slug);
+        std::cout << "Running: " << cmd << "\n" << std::flush;
+        std::system(cmd.c_str());
+      }
+    }
 
-// basic tokenizer: whitespace split, respecting simple single/double quotes
-static std::vector<std::string> shellish_split(const std::string& s) {
-  std::vector<std::string> out;
-  std::string cur;
-  bool in_single = false, in_double = false;
-  for (char c : s) {
-    if (c == '\'' && !in_double) { in_single = !in_single; continue; }
-    if (c == '"'  && !in_single) { in_double = !in_double; continue; }
-
-    if (!in_single && !in_double && std::isspace((unsigned char)c)) {
-      if (!cur.empty()) { out.push_back(cur); cur.clear(); }
-      continue;
+    std::cout << "Watching " << manifest.string() << " (Ctrl-C to stop)\n" << std::flush;
+    for (bool manifest_changed = false; !manifest_changed;) {
+      for (const auto& f : watcher.wait()) {
+        if (f != manifest) {
+          std::cout << f.string() << " changed; rebuild scaffold to pick up new fixups/templates\n";
+        } else {
+          manifest_changed = true;
+        }
+      }
     }
-    cur.push_back(c);
   }
-  if (!cur.empty()) out.push_back(cur);
-  return out;
 }
 
-static std::string normalize_filename(const std::string& tok) {
-  fs::path p(tok);
-  auto leaf = p.filename().string();
-  if (leaf.rfind("./", 0) == 0) leaf = leaf.substr(2);
-  return leaf;
+// ---- serve: answer render/lookup/affected/check over a unix socket ----
+
+static const char* const kDefaultSocket = ".polyglot/scaffold.sock";
+
+static sockaddr_un socket_address(const fs::path& path) {
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  const std::string p = path.string();
+  if (p.size() >= sizeof(addr.sun_path)) throw std::runtime_error("Socket path too long: " + p);
+  std::memcpy(addr.sun_path, p.c_str(), p.size() + 1);
+  return addr;
 }
 
-static std::string find_last_file_ref(const std::string& cmd, const std::string& ext) {
-  if (cmd.empty() || ext.empty()) return "";
-  std::string last;
-  for (auto tok : shellish_split(cmd)) {
-    tok = strip_trailing_punct(tok);
-    tok = normalize_filename(tok);
-    if (ends_with(tok, ext)) last = tok;
+static int connect_socket(const fs::path& path) {
+  const sockaddr_un addr = socket_address(path);
+  int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) throw std::runtime_error(std::string("socket: ") + std::strerror(errno));
+  ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+  if (::connect(fd, (const sockaddr*)&addr, sizeof(addr)) < 0) {
+    ::close(fd);
+    return -1;
   }
-  return last;
+  return fd;
 }
 
-static void remove_quiet(const fs::path& p) {
-  std::error_code ec;
-  fs::remove(p, ec);
+static char g_socket_path[sizeof(sockaddr_un::sun_path)];
+
+static void unlink_socket_and_exit(int) {
+  ::unlink(g_socket_path);
+  _exit(0);
 }
 
-static void remove_case_insensitive_conflicts(const fs::path& dir, const std::string& target) {
-  std::error_code ec;
-  if (!fs::exists(dir, ec)) return;
-
-  const std::string target_l = lower(target);
-  for (const auto& entry : fs::directory_iterator(dir, ec)) {
-    if (ec) break;
-    if (!entry.is_regular_file(ec)) continue;
-    const std::string name = entry.path().filename().string();
-    if (lower(name) == target_l && name != target) {
-      remove_quiet(entry.path());
+// What serve()'s detached threads share. Held through a shared_ptr each of them owns,
+// so it outlives serve() even if that unwinds with workers still running.
+struct ServeState {
+  ServeState(const fs::path& manifest, const fs::path& languages_dir) : service(manifest, languages_dir) {}
+  Service service;
+  std::mutex mu;
+  std::condition_variable cv;
+  std::deque<int> pending;    // connections with a request ready, for the workers
+  std::vector<int> returned;  // answered connections, back to the poll loop
+  int wake[2] = {-1, -1};     // workers -> poll loop: something is in `returned`
+};
+
+// Connections wait in the main thread's poll() between requests; one that has a request
+// ready is queued to a fixed pool of workers, which answers that one request and hands
+// the connection back. Idle keep-alive clients therefore hold no worker, and a request
+// (or its response) has kFrameTimeoutMs in all to get through. A watcher thread swaps in
+// a fresh manifest snapshot whenever languages.tsv changes.
+static constexpr int kFrameTimeoutMs = 10000;
+
+static int serve(const fs::path& manifest, const fs::path& socket_path, unsigned threads) {
+  const auto state = std::make_shared<ServeState>(manifest, fs::current_path() / "languages");
+
+  if (int fd = connect_socket(socket_path); fd >= 0) {
+    ::close(fd);
+    std::cerr << "Already serving on " << socket_path << "\n";
+    return 1;
+  }
+  if (socket_path.has_parent_path()) fs::create_directories(socket_path.parent_path());
+  ::unlink(socket_path.c_str());  // stale from a crashed server
+
+  const sockaddr_un addr = socket_address(socket_path);
+  int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listener < 0 || ::bind(listener, (const sockaddr*)&addr, sizeof(addr)) < 0 || ::listen(listener, 128) < 0) {
+    throw std::runtime_error("Cannot listen on " + socket_path.string() + ": " + std::strerror(errno));
+  }
+  ::fcntl(listener, F_SETFD, FD_CLOEXEC);
+  std::strncpy(g_socket_path, socket_path.c_str(), sizeof(g_socket_path) - 1);
+  std::signal(SIGINT, unlink_socket_and_exit);
+  std::signal(SIGTERM, unlink_socket_and_exit);
+  std::signal(SIGPIPE, SIG_IGN);  // a client going away mid-response is not our problem
+
+  std::thread([state, manifest] {
+    FileWatcher watcher({manifest});
+    for (;;) {
+      watcher.wait();
+      try {
+        state->service.reload();
+        std::cout << "Reloaded " << manifest.string() << "\n" << std::flush;
+      } catch (const std::exception& e) {
+        std::cerr << "Reload failed, still serving the previous manifest: " << e.what() << "\n";
+      }
     }
+  }).detach();
+
+  if (::pipe(state->wake) < 0) throw std::runtime_error(std::string("pipe: ") + std::strerror(errno));
+  ::fcntl(state->wake[0], F_SETFD, FD_CLOEXEC);
+  ::fcntl(state->wake[1], F_SETFD, FD_CLOEXEC);
+  ::fcntl(state->wake[0], F_SETFL, O_NONBLOCK);
+
+  for (unsigned i = 0; i < threads; ++i) {
+    std::thread([state] {
+      ServeState& s = *state;
+      for (;;) {
+        int fd;
+        {
+          std::unique_lock<std::mutex> lock(s.mu);
+          s.cv.wait(lock, [&] { return !s.pending.empty(); });
+          fd = s.pending.front();
+          s.pending.pop_front();
+        }
+        bool keep = false;
+        try {
+          std::string request;
+          if (read_frame(fd, request, kFrameTimeoutMs)) {
+            write_frame(fd, s.service.handle(request), kFrameTimeoutMs);
+            keep = true;
+          }
+        } catch (const std::exception& e) {
+          std::cerr << "Connection dropped: " << e.what() << "\n";
+        }
+        if (!keep) {
+          ::close(fd);
+          continue;
+        }
+        {
+          std::lock_guard<std::mutex> lock(s.mu);
+          s.returned.push_back(fd);
+        }
+        const char byte = 0;
+        (void)!::write(s.wake[1], &byte, 1);
+      }
+    }).detach();
   }
-  remove_quiet(dir / target);
-}
 
-struct LangSpec {
-  std::string slug;
-  std::string file;
-  std::string base_image;
-  std::string install_cmd;
-  std::string env_path;
-  std::string build_cmd;
-  std::string run_cmd;
-  std::string hello;
-};
+  std::cout << "Serving " << manifest.string() << " on " << socket_path.string() << " (" << threads
+            << " threads, Ctrl-C to stop)\n" << std::flush;
+  ServeState& s = *state;
+  std::vector<int> idle;  // connections between requests; this thread only
+  // Out of descriptors, accept() fails while the listener stays readable; stop polling
+  // it for a moment instead of spinning, and keep serving the connections we have.
+  std::chrono::steady_clock::time_point accept_paused_until{};
+  bool accept_starved = false;  // reported once per stretch
+  for (;;) {
+    const auto now = std::chrono::steady_clock::now();
+    const bool paused = now < accept_paused_until;
+    std::vector<pollfd> fds = {{paused ? -1 : listener, POLLIN, 0}, {s.wake[0], POLLIN, 0}};
+    for (int fd : idle) fds.push_back({fd, POLLIN, 0});
+    const int timeout =
+        paused ? (int)std::chrono::duration_cast<std::chrono::milliseconds>(accept_paused_until - now).count() + 1 : -1;
+    if (::poll(fds.data(), fds.size(), timeout) < 0) {
+      if (errno == EINTR || errno == ENOMEM) continue;
+      throw std::runtime_error(std::string("poll: ") + std::strerror(errno));
+    }
 
-static bool icontains(const std::string& hay, const std::string& needle) {
-  auto h = lower(hay);
-  auto n = lower(needle);
-  return h.find(n) != std::string::npos;
-}
+    // Readable (a request, or the hangup read_frame will see) goes to a worker.
+    idle.clear();
+    size_t ready = 0;
+    for (size_t i = 2; i < fds.size(); ++i) {
+      if (!fds[i].revents) {
+        idle.push_back(fds[i].fd);
+        continue;
+      }
+      std::lock_guard<std::mutex> lock(s.mu);
+      s.pending.push_back(fds[i].fd);
+      ++ready;
+    }
+    for (size_t i = 0; i < ready; ++i) s.cv.notify_one();
+
+    if (fds[1].revents) {
+      char drain[256];
+      while (::read(s.wake[0], drain, sizeof(drain)) > 0) {}
+      std::lock_guard<std::mutex> lock(s.mu);
+      idle.insert(idle.end(), s.returned.begin(), s.returned.end());
+      s.returned.clear();
+    }
 
-static void replace_all(std::string& s, const std::string& from, const std::string& to) {
-  if (from.empty()) return;
-  size_t pos = 0;
-  while ((pos = s.find(from, pos)) != std::string::npos) {
-    s.replace(pos, from.size(), to);
-    pos += to.size();
+    if (fds[0].revents) {
+      int fd = ::accept(listener, nullptr, nullptr);
+      if (fd < 0) {
+        if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+          if (!accept_starved) std::cerr << "accept: " << std::strerror(errno) << "; pausing new connections\n";
+          accept_starved = true;
+          accept_paused_until = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+          continue;
+        }
+        if (errno == EINTR || errno == ECONNABORTED) continue;
+        throw std::runtime_error(std::string("accept: ") + std::strerror(errno));
+      }
+      accept_starved = false;
+      ::fcntl(fd, F_SETFD, FD_CLOEXEC);  // affected spawns git; don't leak clients into it
+      idle.push_back(fd);
+    }
   }
 }
 
-static void ensure_contains_pkg(std::string& install_cmd, const std::string& pkg_token) {
-  // Very light heuristic: only add if not already present.
-  if (icontains(install_cmd, pkg_token)) return;
-  // Try to insert right after "--no-install-recommends" if present.
-  auto key = std::string("--no-install-recommends");
-  auto p = install_cmd.find(key);
-  if (p != std::string::npos) {
-    p += key.size();
-    install_cmd.insert(p, " " + pkg_token);
-  } else {
-    // Otherwise just append token (works for simple one-line installs)
-    install_cmd += " " + pkg_token;
+// Sends one request to a running `scaffold serve` and prints the answer: each record's
+// key (and flags), then its value if it has one.
+static int query(const fs::path& socket_path, const std::string& request) {
+  int fd = connect_socket(socket_path);
+  if (fd < 0) {
+    std::cerr << "Nothing serving on " << socket_path << " (start scaffold serve)\n";
+    return 2;
   }
+  std::string response;
+  write_frame(fd, request);
+  const bool got = read_frame(fd, response);
+  ::close(fd);
+  if (!got || response.empty()) throw std::runtime_error("Server closed the connection");
+  if (response[0] != '+') {
+    std::cerr << response.substr(1) << "\n";
+    return 1;
+  }
+  for (const auto& r : parse_records(response)) {
+    std::cout << r.key;
+    if (!r.flags.empty()) std::cout << "\t" << r.flags;
+    std::cout << "\n";
+    if (!r.value.empty()) std::cout << r.value << (ends_with_nl(r.value) ? "" : "\n");
+  }
+  return 0;
 }
 
-// Durable fixups so you don't hand-edit Dockerfiles.
-static void apply_fixups(LangSpec& s) {
-  // COBOL:
-  // Your source is free-format (starts in column 1). GnuCOBOL defaults to fixed-format,
-  // which causes "invalid indicator ... at column 7". Add `-free` to cobc.
-  if (s.slug == "cobol") {
-    if (icontains(s.build_cmd, "cobc") && !icontains(s.build_cmd, "-free")) {
-      // Insert "-free" after "cobc" token.
-      // Handles: "cobc -x ..." and "cobc ...".
-      replace_all(s.build_cmd, "cobc -", "cobc -free -");
-      if (s.build_cmd.rfind("cobc ", 0) == 0 && !icontains(s.build_cmd, "cobc -free")) {
-        // If it was "cobc hello.cob ..." (no flags), just prefix.
-        replace_all(s.build_cmd, "cobc ", "cobc -free ");
-      }
-      // If still not present (weird formatting), append as last resort.
-      if (!icontains(s.build_cmd, "-free")) s.build_cmd = "cobc -free " + s.build_cmd.substr(5);
+static int serve_main(int argc, char** argv) {
+  fs::path manifest = "languages.tsv";
+  fs::path socket_path = kDefaultSocket;
+  unsigned threads = std::max(2u, std::thread::hardware_concurrency());
+  std::vector<std::string> words;
+  for (int i = 2; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--socket" && i + 1 < argc) socket_path = argv[++i];
+    else if (arg == "--threads" && i + 1 < argc) threads = std::max(1, std::atoi(argv[++i]));
+    else if (arg.rfind("--", 0) == 0) {
+      std::cerr << "Unknown argument: " << arg << "\n";
+      return 2;
+    } else {
+      words.push_back(arg);
     }
   }
 
-  // Emojicode:
-  // Don’t splice into the user heredoc (it’s easy to break "\" continuations).
-  // Instead, normalize to Ubuntu 20.04 and replace install_cmd with a robust heredoc
-  // that installs LLVM/Clang 8 properly and builds emojicode.
-  if (s.slug == "emojicode") {
-    s.base_image = "ubuntu:20.04";
-    s.env_path   = "/usr/local/bin";
-
-    s.install_cmd =
-      "<<'EOF'\n"
-      "set -e\n"
-      "export DEBIAN_FRONTEND=noninteractive\n"
-      "apt-get update\n"
-      "\n"
-      "# Toolchain + deps\n"
-      "apt-get install -y --no-install-recommends \\\n"
-      "  ca-certificates \\\n"
-      "  build-essential \\\n"
-      "  cmake \\\n"
-      "  git \\\n"
-      "  libffi-dev \\\n"
-      "  libedit-dev \\\n"
-      "  zlib1g-dev \\\n"
-      "  clang-8 \\\n"
-      "  llvm-8 \\\n"
-      "  llvm-8-dev \\\n"
-      "  llvm-8-tools\n"
-      "\n"
-      "rm -rf /var/lib/apt/lists/*\n"
-      "\n"
-      "# Ensure v8 tools are the defaults (only if the paths exist)\n"
-      "if [ -x /usr/bin/llvm-config-8 ]; then\n"
-      "  update-alternatives --install /usr/bin/llvm-config llvm-config /usr/bin/llvm-config-8 100 || true\n"
-      "fi\n"
-      "if [ -x /usr/bin/clang-8 ]; then\n"
-      "  update-alternatives --install /usr/bin/clang clang /usr/bin/clang-8 100 || true\n"
-      "fi\n"
-      "if [ -x /usr/bin/clang++-8 ]; then\n"
-      "  update-alternatives --install /usr/bin/clang++ clang++ /usr/bin/clang++-8 100 || true\n"
-      "fi\n"
-      "\n"
-      "# Build emojicode\n"
-      "git clone --depth=1 https://github.com/emojicode/emojicode.git /tmp/emojic\n"
-      "mkdir -p /tmp/emojic/build\n"
-      "cd /tmp/emojic/build\n"
-      "\n"
-      "LLVM_DIR=\"$(llvm-config --cmakedir 2>/dev/null || true)\"\n"
-      "if [ -z \"$LLVM_DIR\" ]; then\n"
-      "  LLVM_DIR=\"$(llvm-config --prefix)/lib/cmake/llvm\"\n"
-      "fi\n"
-      "\n"
-      "cmake -DLLVM_DIR=\"$LLVM_DIR\" ..\n"
-      "make -j\"$(nproc)\"\n"
-      "make install\n"
-      "rm -rf /tmp/emojic\n"
-      "EOF";
+  if (std::string(argv[1]) == "query") {
+    if (words.empty() || words.size() > 2) {
+      std::cerr << "Usage: scaffold query <ping|slugs|lookup|render|affected|check> [arg] [--socket PATH]\n";
+      return 2;
+    }
+    return query(socket_path, words.size() == 2 ? words[0] + "\t" + words[1] : words[0]);
   }
 
-  // Julia PATH nudge
-  if (s.env_path.empty() && s.base_image.rfind("julia:", 0) == 0) {
-    s.env_path = "/usr/local/julia/bin";
+  if (words.size() > 1) {
+    std::cerr << "Usage: scaffold serve [languages.tsv] [--socket PATH] [--threads N]\n";
+    return 2;
   }
+  if (!words.empty()) manifest = words[0];
+  return serve(manifest, socket_path, threads);
 }
 
 int main(int argc, char** argv) {
   try {
+    if (argc >= 2 && (std::string(argv[1]) == "serve" || std::string(argv[1]) == "query")) {
+      return serve_main(argc, argv);
+    }
     if (argc < 2) {
-      std::cerr << "Usage: scaffold <languages.tsv> [--force]\n";
+      std::cerr << "Usage: scaffold <languages.tsv> [--force] [--check] [--affected <git-rev>] [--watch [--run]] [--stats] [--emit-registry <header>]\n"
+                   "                [--output-archive <out.tar[.zst]>]\n"
+                   "       scaffold serve [languages.tsv] [--socket PATH] [--threads N]\n"
+                   "       scaffold query <op> [arg] [--socket PATH]\n";
       return 2;
     }
 
     const fs::path manifest = argv[1];
-    const bool force = (argc >= 3 && std::string(argv[2]) == "--force");
+    bool force = false;
+    bool check_mode = false;
+    bool watch_mode = false;
+    bool watch_run = false;
+    bool show_stats = false;
+    std::string affected_rev;
+    fs::path registry;
+    fs::path archive;
+    for (int i = 2; i < argc; ++i) {
+      const std::string arg = argv[i];
+      if (arg == "--force") force = true;
+      else if (arg == "--check") check_mode = true;
+      else if (arg == "--watch") watch_mode = true;
+      else if (arg == "--run") watch_run = true;
+      else if (arg == "--stats") show_stats = true;
+      else if (arg == "--affected" && i + 1 < argc) affected_rev = argv[++i];
+      else if (arg == "--emit-registry" && i + 1 < argc) registry = argv[++i];
+      else if (arg == "--output-archive" && i + 1 < argc) archive = argv[++i];
+      else {
+        std::cerr << "Unknown argument: " << arg << "\n";
+        return 2;
+      }
+    }
 
-    std::ifstream in(manifest);
-    if (!in) {
-      std::cerr << "Cannot open manifest: " << manifest << "\n";
-      return 2;
+    if (!affected_rev.empty()) {
+      for (const auto& slug : affected_slugs(manifest, affected_rev)) std::cout << slug << "\n";
+      return 0;
     }
 
+    if (show_stats) stats::enable();
     const fs::path root = fs::current_path();
     const fs::path languages_dir = root / "languages";
-    fs::create_directories(languages_dir);
+    // In the repo the embedded registry header is kept in step like languages/ is.
+    if (registry.empty() && fs::is_directory(fs::path(kRegistryHeader).parent_path())) registry = kRegistryHeader;
 
-    std::unordered_map<std::string, size_t> h;
-    bool has_header = false;
+    // Read-only: renders in memory, never touches languages/.
+    if (check_mode) return check(manifest, languages_dir, registry);
 
-    std::string first;
-    if (!std::getline(in, first)) return 0;
-
-    auto first_cols = split_tabs(first);
-    if (looks_like_header(first_cols)) {
-      has_header = true;
-      for (size_t i = 0; i < first_cols.size(); ++i) {
-        auto key = lower(trim(first_cols[i]));
-        if (!key.empty()) h[key] = i;
-      }
+    std::ifstream in(manifest);
+    if (!in) {
+      std::cerr << "Cannot open manifest: " << manifest << "\n";
+      return 2;
     }
 
-    const size_t kNoIndex = (size_t)-1;
-
-    auto get = [&](const std::vector<std::string>& cols,
-                   const std::string& name,
-                   size_t fallback_index) -> std::string {
-      if (has_header) {
-        auto it = h.find(name);
-        if (it != h.end() && it->second < cols.size()) return cols[it->second];
-      }
-      if (fallback_index != kNoIndex && fallback_index < cols.size()) return cols[fallback_index];
-      return "";
-    };
-
-    auto process_line = [&](const std::string& raw_line) {
-      std::string line = raw_line;
-      if (trim(line).empty()) return;
-      if (!trim(line).empty() && trim(line)[0] == '#') return;
-
-      auto cols = split_tabs(line);
-
-      LangSpec spec;
-      spec.slug       = trim(get(cols, "slug",       0));
-      spec.file       = trim(get(cols, "file",       1));
-      spec.base_image = trim(get(cols, "base_image", 2));
-
-      spec.install_cmd = trim(get(cols, "install_cmd", kNoIndex));
-      spec.env_path    = trim(get(cols, "env_path",    kNoIndex));
-
-      spec.build_cmd   = trim(get(cols, "build_cmd",   3));
-      spec.run_cmd     = trim(get(cols, "run_cmd",     4));
-      spec.hello       = get(cols, "hello",           5);
-
-      if (spec.slug.empty() || spec.file.empty() || spec.base_image.empty() || spec.run_cmd.empty()) {
-        std::cerr << "Skipping malformed line: " << line << "\n";
-        return;
-      }
+    MerkleIndex index(root / ".polyglot" / "merkle");
+    std::string text;
+    {
+      stats::Probe probe(stats::kManifestRead);
+      text = read_file_or_empty(manifest);
+    }
 
-      // Unescape + strip BOMs
-      spec.slug        = strip_utf8_bom(unescape(spec.slug));
-      spec.file        = strip_utf8_bom(unescape(spec.file));
-      spec.base_image  = strip_utf8_bom(unescape(spec.base_image));
-      spec.install_cmd = strip_utf8_bom(unescape(spec.install_cmd));
-      spec.env_path    = strip_utf8_bom(unescape(spec.env_path));
-      spec.build_cmd   = strip_utf8_bom(unescape(spec.build_cmd));
-      spec.run_cmd     = strip_utf8_bom(unescape(spec.run_cmd));
-      spec.hello       = strip_utf8_bom(unescape(spec.hello));
-
-      // Apply durable fixups
-      apply_fixups(spec);
-
-      // Determine filename to generate/copy.
-      std::string effective_file = normalize_filename(spec.file);
-      const std::string ext = file_ext(effective_file);
-
-      const std::string build_ref = normalize_filename(find_last_file_ref(spec.build_cmd, ext));
-      const std::string run_ref   = normalize_filename(find_last_file_ref(spec.run_cmd, ext));
-
-      if (!build_ref.empty()) effective_file = build_ref;
-      else if (!run_ref.empty()) effective_file = run_ref;
-
-      fs::path dir = languages_dir / spec.slug;
-      fs::create_directories(dir);
-
-      // Ensure build context isn't accidentally excluding everything.
-      const std::string dockerignore =
-        ".DS_Store\n"
-        ".git\n"
-        ".gitignore\n";
-      write_file(dir / ".dockerignore", dockerignore, force);
-
-      // macOS case-only rename handling:
-      remove_case_insensitive_conflicts(dir, effective_file);
-
-      // Ensure hello ends with newline
-      std::string hello_content = spec.hello;
-      if (!ends_with_nl(hello_content)) hello_content.push_back('\n');
-      write_file(dir / effective_file, hello_content, true /* always write exact-name */);
-
-      // Dockerfile
-      std::ostringstream dockerfile;
-      dockerfile
-        << "# syntax=docker/dockerfile:1\n"
-        << "FROM " << spec.base_image << "\n"
-        << "WORKDIR /app\n";
-
-      if (!spec.install_cmd.empty()) {
-        std::string trimmed_install = trim(spec.install_cmd);
-        if (trimmed_install.rfind("<<", 0) == 0) {
-          dockerfile << "RUN " << trimmed_install << "\n";
-        } else {
-          dockerfile << "RUN " << spec.install_cmd << "\n";
-        }
+    // The whole tree as one archive, in one write; languages/ is left alone.
+    if (!archive.empty()) {
+      const Manifest m = Manifest::parse(text);
+      TarWriter tar;
+      for (const auto& slug : m.slugs()) {
+        const auto artifacts = render(*m.find(slug));
+        tar.add_slug(slug, artifacts);
+        index.update(slug, artifacts);
       }
+      index.retain(m.slugs());
+      write_archive(archive, tar.finish());
+      std::cout << "Archived " << m.slugs().size() << " languages to " << archive.string() << "\n";
+      std::cout << "Tree hash: " << index.save() << "\n";
+      return 0;
+    }
 
-      if (!spec.env_path.empty())
-        dockerfile << "ENV PATH=\"" << spec.env_path << ":$PATH\"\n";
-
-      dockerfile << "COPY " << effective_file << " .\n";
-      if (!spec.build_cmd.empty()) dockerfile << "RUN " << spec.build_cmd << "\n";
-      dockerfile << "CMD [\"sh\", \"-c\", \"" << json_escape(spec.run_cmd) << "\"]\n";
-
-      write_file(dir / "Dockerfile", dockerfile.str(), force);
-
-      // run.sh
-      std::ostringstream runsh;
-      runsh
-        << "#!/usr/bin/env bash\n"
-        << "set -euo pipefail\n"
-        << "IMG=\"hello-" << spec.slug << "\"\n"
-        << "PLATFORM=\"${POLYGLOT_PLATFORM:-}\"\n"
-        << "if [ -n \"$PLATFORM\" ]; then\n"
-        << "  docker build --platform \"$PLATFORM\" -t \"$IMG\" .\n"
-        << "  docker run --rm --platform \"$PLATFORM\" \"$IMG\"\n"
-        << "else\n"
-        << "  docker build -t \"$IMG\" .\n"
-        << "  docker run --rm \"$IMG\"\n"
-        << "fi\n";
-
-      write_file(dir / "run.sh", runsh.str(), force);
-
-      fs::permissions(dir / "run.sh",
-                      fs::perms::owner_exec | fs::perms::group_exec | fs::perms::others_exec,
-                      fs::perm_options::add);
-
+    fs::create_directories(languages_dir);
+    if (watch_mode) return watch(manifest, languages_dir, registry, index, force, watch_run);
+
+    const Manifest m = Manifest::parse(text);
+    for (const auto& spec : m.rows()) {
+      const auto artifacts = render(spec);
+      write_artifacts(languages_dir / spec.slug, artifacts, force);
+      // Only the row that ends up on disk goes into the index.
+      if (m.find(spec.slug) == &spec) index.update(spec.slug, artifacts);
       std::cout << "Scaffolded: " << spec.slug << "\n";
-    };
-
-    if (!has_header) process_line(first);
-
-    std::string line;
-    while (std::getline(in, line)) {
-      process_line(line);
     }
+    index.retain(m.slugs());
+    std::cout << "Tree hash: " << index.save() << "\n";
+    if (!registry.empty() && write_file_if_changed(registry, emit_registry(m, fnv1a(text)))) {
+      std::cout << "Registry: " << registry.string() << "\n";
+    }
+    if (show_stats) stats::report(std::cerr);
 
     return 0;
   } catch (const std::exception& e) {